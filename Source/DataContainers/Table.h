@@ -2,6 +2,11 @@
 #define DECISION_TREE_2_TABLE_H
 
 #include <vector>
+#include <span>
+#include <memory>
+#include <cassert>
+#include <algorithm>
+#include <stdexcept>
 #include <ostream>
 #include <DataContainers/TableTraits/TableRow.h>
 #include <DataContainers/TableTraits/TableColumn.h>
@@ -17,24 +22,42 @@ namespace DataContainers {
             SetNumOfColumns(numOfColumns);
         }
 
+        /// Read-only table over external column-major storage, e.g. a mapped file, which is copied on the first modification
+        Table(std::shared_ptr<const void> storageOwner, const StoredType* data, int numOfRows, int numOfColumns, int rowStride)
+            : m_numOfRows(numOfRows)
+            , m_numOfColumns(numOfColumns)
+            , m_rowCapacity(rowStride)
+            , m_mappedStorageOwner(std::move(storageOwner))
+            , m_mappedData(data)
+        {
+            if (numOfRows < 0 || numOfColumns < 0 || rowStride < numOfRows)
+                throw std::invalid_argument("Invalid shape of mapped table storage");
+        }
+
         [[nodiscard]] int GetNumOfRows() const { return m_numOfRows; };
         void SetNumOfRows(int numOfRows) {
             if (numOfRows < 0)
                 throw std::invalid_argument("Number of rows is less than zero");
 
-            if (m_numOfRows > numOfRows)
-                RemoveRowsFromEnd(m_numOfRows - numOfRows);
-            else if (m_numOfRows < numOfRows)
+            if (m_numOfRows < numOfRows)
                 AddRowsFromEnd(numOfRows - m_numOfRows);
 
             m_numOfRows = numOfRows;
         }
 
+        [[nodiscard]] int GetRowCapacity() const { return m_rowCapacity; }
+        [[nodiscard]] bool IsStorageMapped() const { return m_mappedData != nullptr; }
+        void ReserveRows(int numOfRows) {
+            if (numOfRows > m_rowCapacity)
+                Reallocate(numOfRows);
+        }
+
         [[nodiscard]] int GetNumOfColumns() const { return m_numOfColumns; };
         void SetNumOfColumns(int numOfColumns) {
             if (numOfColumns < 0)
                 throw std::invalid_argument("Number of columns is less than zero");
 
+            DetachMappedStorage();
             if (m_numOfColumns > numOfColumns)
                 RemoveColumnsFromEnd(m_numOfColumns - numOfColumns);
             else if (m_numOfColumns < numOfColumns)
@@ -48,7 +71,7 @@ namespace DataContainers {
             RowIndexCheck(rowIndex);
 
             for (int columnIndex = 0; columnIndex < m_numOfColumns; ++columnIndex, ++outRange)
-                *outRange = m_tableData[GetElementIndexInTableData(rowIndex, columnIndex)];
+                *outRange = GetTableData()[GetElementIndexInTableData(rowIndex, columnIndex)];
         }
 
         auto GetRow(int rowIndex) { return TableTraits::TableRow(rowIndex, *this); }
@@ -70,13 +93,24 @@ namespace DataContainers {
         void GetColumn(int columnIndex, Out&& outRange) const {
             ColumnIndexCheck(columnIndex);
 
-            for (int rowIndex = 0; rowIndex < m_numOfRows; ++columnIndex, ++outRange)
-                *outRange = m_tableData[GetElementIndexInTableData(rowIndex, columnIndex)];
+            for (int rowIndex = 0; rowIndex < m_numOfRows; ++rowIndex, ++outRange)
+                *outRange = GetTableData()[GetElementIndexInTableData(rowIndex, columnIndex)];
         }
 
         auto GetColumn(int columnIndex) { return TableTraits::TableColumn(columnIndex, *this); }
         auto GetColumn(int columnIndex) const { return TableTraits::TableColumn(columnIndex, *this); }
 
+        [[nodiscard]] std::span<StoredType> GetColumnSpan(int columnIndex) {
+            ColumnIndexCheck(columnIndex);
+            DetachMappedStorage();
+            return {std::next(m_tableData.begin(), GetElementIndexInTableData(0, columnIndex)), static_cast<std::size_t>(m_numOfRows)};
+        }
+
+        [[nodiscard]] std::span<const StoredType> GetColumnSpan(int columnIndex) const {
+            ColumnIndexCheck(columnIndex);
+            return {GetTableData() + GetElementIndexInTableData(0, columnIndex), static_cast<std::size_t>(m_numOfRows)};
+        }
+
         template<std::ranges::input_range Range>
         void PushBackColumn(Range&& inputRange) {
             auto inputRangeBegin = std::ranges::begin(inputRange);
@@ -92,6 +126,7 @@ namespace DataContainers {
         [[nodiscard]] StoredType& At(int rowIndex, int columnIndex) {
             RowIndexCheck(rowIndex);
             ColumnIndexCheck(columnIndex);
+            DetachMappedStorage();
 
             return m_tableData[GetElementIndexInTableData(rowIndex, columnIndex)];
         }
@@ -100,9 +135,20 @@ namespace DataContainers {
             RowIndexCheck(rowIndex);
             ColumnIndexCheck(columnIndex);
 
+            return GetTableData()[GetElementIndexInTableData(rowIndex, columnIndex)];
+        }
+
+        [[nodiscard]] StoredType& AtUnchecked(int rowIndex, int columnIndex) {
+            assert(rowIndex >= 0 && rowIndex < m_numOfRows && columnIndex >= 0 && columnIndex < m_numOfColumns);
+            DetachMappedStorage();
             return m_tableData[GetElementIndexInTableData(rowIndex, columnIndex)];
         }
 
+        [[nodiscard]] const StoredType& AtUnchecked(int rowIndex, int columnIndex) const {
+            assert(rowIndex >= 0 && rowIndex < m_numOfRows && columnIndex >= 0 && columnIndex < m_numOfColumns);
+            return GetTableData()[GetElementIndexInTableData(rowIndex, columnIndex)];
+        }
+
     private:
         inline void RowIndexCheck(int rowIndex) const {
             if (rowIndex < 0 || rowIndex >= m_numOfRows)
@@ -114,31 +160,56 @@ namespace DataContainers {
                 throw std::out_of_range("Column index out of range");
         }
 
-        [[nodiscard]] inline int GetElementIndexInTableData(int rowIndex, int columnIndex) const { return columnIndex * m_numOfRows + rowIndex; }
+        [[nodiscard]] inline std::size_t GetElementIndexInTableData(int rowIndex, int columnIndex) const {
+            return static_cast<std::size_t>(columnIndex) * m_rowCapacity + rowIndex;
+        }
+
+        [[nodiscard]] const StoredType* GetTableData() const { return m_mappedData != nullptr ? m_mappedData : m_tableData.data(); }
+
+        void DetachMappedStorage() {
+            if (m_mappedData != nullptr)
+                Reallocate(m_rowCapacity);
+        }
+
+        void Reallocate(int rowCapacity) {
+            std::vector<StoredType> tableData(static_cast<std::size_t>(rowCapacity) * m_numOfColumns);
+            for (int columnIndex = 0; columnIndex < m_numOfColumns; ++columnIndex)
+                std::copy_n(GetTableData() + GetElementIndexInTableData(0, columnIndex), m_numOfRows,
+                            std::next(tableData.begin(), static_cast<std::size_t>(columnIndex) * rowCapacity));
 
-        void RemoveRowsFromEnd(int numOfRemoveRows) {
-            auto endRowIt = std::next(m_tableData.begin(), m_numOfRows);
-            for (int i = 0; i < m_numOfColumns; ++i, endRowIt += m_numOfRows)
-                endRowIt = m_tableData.erase(std::prev(endRowIt, numOfRemoveRows), endRowIt);
+            m_tableData = std::move(tableData);
+            m_rowCapacity = rowCapacity;
+            m_mappedData = nullptr;
+            m_mappedStorageOwner.reset();
         }
 
         void AddRowsFromEnd(int numOfAddRows) {
-            auto endRowIt = std::next(m_tableData.begin(), m_numOfRows);
-            for (int i = 0; i < m_numOfColumns; ++i, endRowIt += m_numOfRows + numOfAddRows)
-                endRowIt = m_tableData.insert(endRowIt, numOfAddRows, 0.0);
+            const int numOfRows = m_numOfRows + numOfAddRows;
+            if (numOfRows > m_rowCapacity)
+                Reallocate(std::max(numOfRows, 2 * m_rowCapacity));
+            else
+                DetachMappedStorage();
+
+            for (int columnIndex = 0; columnIndex < m_numOfColumns; ++columnIndex) {
+                const auto columnBegin = std::next(m_tableData.begin(), GetElementIndexInTableData(0, columnIndex));
+                std::fill(std::next(columnBegin, m_numOfRows), std::next(columnBegin, numOfRows), StoredType{});
+            }
         }
 
         void RemoveColumnsFromEnd(int numOfRemoveColumns) {
-            m_tableData.erase(std::prev(m_tableData.end(), m_numOfRows * numOfRemoveColumns), m_tableData.end());
+            m_tableData.resize(static_cast<std::size_t>(m_rowCapacity) * (m_numOfColumns - numOfRemoveColumns));
         }
         void AddColumnsFromEnd(int numOfAddColumns) {
-            m_tableData.resize(m_numOfRows * (m_numOfColumns + numOfAddColumns));
+            m_tableData.resize(static_cast<std::size_t>(m_rowCapacity) * (m_numOfColumns + numOfAddColumns));
         }
 
     private:
-        int m_numOfRows = 0;                   ///< Number of rows in the table
-        int m_numOfColumns = 0;                ///< Number of columns in the table
-        std::vector<StoredType> m_tableData;   ///< Table data
+        int m_numOfRows = 0;                                ///< Number of rows in the table
+        int m_numOfColumns = 0;                             ///< Number of columns in the table
+        int m_rowCapacity = 0;                              ///< Number of rows the storage of every column has room for
+        std::vector<StoredType> m_tableData;                ///< Column-major table data, column stride is m_rowCapacity
+        std::shared_ptr<const void> m_mappedStorageOwner;   ///< Keeps the mapped storage alive while the table reads from it
+        const StoredType* m_mappedData = nullptr;           ///< Mapped column-major table data, used instead of m_tableData if set
     };
 }
 
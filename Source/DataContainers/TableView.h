@@ -2,6 +2,10 @@
 #define DECISION_TREE_2_TABLEVIEW_H
 
 #include <vector>
+#include <span>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
 #include <DataContainers/Table.h>
 #include <DataContainers/TableTraits/TableRow.h>
 #include <DataContainers/TableTraits/TableColumn.h>
@@ -19,16 +23,23 @@ namespace DataContainers {
         const Table<StoredType>& GetViewableTable() const { return *m_viewableTable; };
 
         [[nodiscard]] const StoredType& At(int rowIndex, int columnIndex) const {
-            return m_viewableTable->At(GetViewableTableRowIndex(rowIndex), GetViewableTableColumnIndex(columnIndex));
+            return m_viewableTable->At(GetViewableTableRowIndex(rowIndex) + GetViewableTableColumnRowShift(columnIndex), GetViewableTableColumnIndex(columnIndex));
         }
 
-        [[nodiscard]] int GetNumOfRows() const { return m_viewableRows.empty() ? m_viewableTable->GetNumOfRows() : m_viewableRows.size(); }
+        [[nodiscard]] const StoredType& AtUnchecked(int rowIndex, int columnIndex) const {
+            assert(rowIndex >= 0 && rowIndex < GetNumOfRows() && columnIndex >= 0 && columnIndex < GetNumOfColumns());
+            return m_viewableTable->AtUnchecked(GetViewableTableRowIndex(rowIndex) + GetViewableTableColumnRowShift(columnIndex), GetViewableTableColumnIndex(columnIndex));
+        }
+
+        [[nodiscard]] int GetNumOfRows() const { return m_viewableRows.empty() ? GetNumOfViewableTableRows() : m_viewableRows.size(); }
         [[nodiscard]] int GetNumOfColumns() const { return  m_viewableColumns.empty() ? m_viewableTable->GetNumOfColumns() : m_viewableColumns.size(); }
 
         void PushBackViewableRowIndex(int viewableTableRowIndex) {
-            if (viewableTableRowIndex < 0 || viewableTableRowIndex >= m_viewableTable->GetNumOfRows())
+            if (viewableTableRowIndex < 0 || viewableTableRowIndex >= GetNumOfViewableTableRows())
                 throw std::out_of_range("Viewable table row index is out of range");
+            m_areViewableRowsContiguous = m_areViewableRowsContiguous && (m_viewableRows.empty() || m_viewableRows.back() + 1 == viewableTableRowIndex);
             m_viewableRows.push_back(viewableTableRowIndex);
+            m_maxViewableRowIndex = std::max(m_maxViewableRowIndex, viewableTableRowIndex);
         }
 
         template<std::weakly_incrementable Out>
@@ -39,22 +50,68 @@ namespace DataContainers {
 
         auto GetRow(int rowIndex) const { return TableTraits::TableRow(rowIndex, *this); }
 
-        void PushBackViewableColumnIndex(int viewableTableColumnIndex) {
+        /// View column reads viewable table column shifted down by rowShift rows: view(r, c) = table(row(r) + rowShift, column(c))
+        void PushBackViewableColumnIndex(int viewableTableColumnIndex, int rowShift = 0) {
             if (viewableTableColumnIndex < 0 || viewableTableColumnIndex >= m_viewableTable->GetNumOfColumns())
                 throw std::out_of_range("Viewable table column index is out of range");
+            if (rowShift < 0 || rowShift >= m_viewableTable->GetNumOfRows() - m_maxViewableRowIndex)
+                throw std::out_of_range("Viewable table column row shift is out of range");
+
+            if (rowShift != 0 || !m_viewableColumnRowShifts.empty()) {
+                m_viewableColumnRowShifts.resize(m_viewableColumns.size(), 0);
+                m_viewableColumnRowShifts.push_back(rowShift);
+            }
+
             m_viewableColumns.push_back(viewableTableColumnIndex);
+            m_maxViewableColumnRowShift = std::max(m_maxViewableColumnRowShift, rowShift);
         }
 
         template<std::weakly_incrementable Out>
         void GetColumn(int columnIndex, Out&& outRange) const {
+            const auto column = GetViewableTableColumnSpan(columnIndex);
             for (int rowIndex = 0; rowIndex < GetNumOfRows(); ++rowIndex, ++outRange)
-                *outRange = At(rowIndex, columnIndex);
+                *outRange = column[GetViewableTableRowIndex(rowIndex)];
         }
 
         auto GetColumn(int columnIndex) const { return TableTraits::TableColumn(columnIndex, *this); }
 
-        void ClearViewableRows() { m_viewableRows.clear(); }
-        void ClearViewableColumns() { m_viewableColumns.clear(); }
+        /// Whole column of the viewable table starting at the column row shift, to be indexed by GetViewableTableRowIndex
+        [[nodiscard]] std::span<const StoredType> GetViewableTableColumnSpan(int columnIndex) const {
+            return m_viewableTable->GetColumnSpan(GetViewableTableColumnIndex(columnIndex)).subspan(GetViewableTableColumnRowShift(columnIndex));
+        }
+
+        [[nodiscard]] bool AreRowsContiguous() const { return m_areViewableRowsContiguous; }
+
+        [[nodiscard]] std::span<const StoredType> GetColumnSpan(int columnIndex) const {
+            if (!m_areViewableRowsContiguous)
+                throw std::logic_error("Viewable rows are not contiguous");
+
+            const auto column = GetViewableTableColumnSpan(columnIndex);
+            return column.subspan(m_viewableRows.empty() ? 0 : m_viewableRows.front(), GetNumOfRows());
+        }
+
+        /// View over the same table and columns whose rows are still to be pushed back
+        [[nodiscard]] TableView CopyWithoutViewableRows() const {
+            TableView res(*m_viewableTable);
+            res.m_viewableColumns = m_viewableColumns;
+            res.m_viewableColumnRowShifts = m_viewableColumnRowShifts;
+            res.m_maxViewableColumnRowShift = m_maxViewableColumnRowShift;
+            return res;
+        }
+
+        void ClearViewableRows() {
+            m_viewableRows.clear();
+            m_areViewableRowsContiguous = true;
+            m_maxViewableRowIndex = 0;
+        }
+        void ClearViewableColumns() {
+            m_viewableColumns.clear();
+            m_viewableColumnRowShifts.clear();
+            m_maxViewableColumnRowShift = 0;
+        }
+
+        /// Number of viewable table rows every view column can be read at
+        [[nodiscard]] int GetNumOfViewableTableRows() const { return m_viewableTable->GetNumOfRows() - m_maxViewableColumnRowShift; }
 
         [[nodiscard]] int GetViewableTableRowIndex(int viewRowIndex) const {
             return m_viewableRows.empty() ? viewRowIndex : m_viewableRows[viewRowIndex];
@@ -64,9 +121,17 @@ namespace DataContainers {
             return m_viewableColumns.empty() ? viewColumnIndex : m_viewableColumns[viewColumnIndex];
         }
 
+        [[nodiscard]] int GetViewableTableColumnRowShift(int viewColumnIndex) const {
+            return m_viewableColumnRowShifts.empty() ? 0 : m_viewableColumnRowShifts[viewColumnIndex];
+        }
+
     private:
         std::vector<int> m_viewableRows;
         std::vector<int> m_viewableColumns;
+        std::vector<int> m_viewableColumnRowShifts;     ///< Empty while every column is unshifted
+        int m_maxViewableRowIndex = 0;
+        int m_maxViewableColumnRowShift = 0;
+        bool m_areViewableRowsContiguous = true;
         const Table<StoredType>* m_viewableTable = nullptr;
     };
 
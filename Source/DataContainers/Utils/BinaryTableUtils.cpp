@@ -0,0 +1,160 @@
+#include "BinaryTableUtils.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace DataContainers::BinaryTableUtils {
+    namespace {
+        constexpr std::string_view Magic = "DT2TABLE";
+
+        struct FileHeader {
+            char Magic[8];
+            std::uint32_t Version;
+            std::uint32_t NumOfTables;
+        };
+
+        struct TableHeader {
+            std::uint32_t Type;
+            std::uint32_t ElementSize;
+            std::int64_t NumOfRows;
+            std::int64_t NumOfColumns;
+            std::int64_t RowStride;
+            std::uint64_t DataOffset;
+            std::uint32_t NumOfColumnNames;
+            std::uint32_t Reserved;
+        };
+
+        std::size_t GetElementTypeSize(ElementType type) {
+            switch (type) {
+                case ElementType::Float32:
+                case ElementType::Int32:
+                    return 4;
+                case ElementType::Float64:
+                case ElementType::Int64:
+                    return 8;
+            }
+
+            return 0;
+        }
+
+        std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        template<class T>
+        void WriteBinaryValue(std::ostream& out, const T& value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        class BinaryReader {
+        public:
+            explicit BinaryReader(const MappedFile& file) : m_file(&file) {}
+
+            template<class T>
+            [[nodiscard]] T Read() {
+                T value;
+                std::memcpy(&value, ReadBytes(sizeof(T)).data(), sizeof(T));
+                return value;
+            }
+
+            [[nodiscard]] std::string_view ReadBytes(std::size_t numOfBytes) {
+                if (numOfBytes > m_file->GetSize() - m_offset)
+                    throw std::invalid_argument("Binary table file is truncated");
+
+                const auto bytes = m_file->GetContent().substr(m_offset, numOfBytes);
+                m_offset += numOfBytes;
+                return bytes;
+            }
+
+        private:
+            const MappedFile* m_file;
+            std::size_t m_offset = 0;
+        };
+    }
+
+    void LayOutBinaryTables(std::vector<BinaryTableInfo>& tableInfos) {
+        std::uint64_t offset = sizeof(FileHeader) + tableInfos.size() * sizeof(TableHeader);
+        for (const auto& tableInfo : tableInfos)
+            for (const auto& columnName : tableInfo.ColumnNames)
+                offset += sizeof(std::uint32_t) + columnName.size();
+
+        for (auto& tableInfo : tableInfos) {
+            const auto numOfAlignedElements = ColumnAlignment / tableInfo.ElementSize;
+            tableInfo.RowStride = static_cast<int>(AlignUp(tableInfo.NumOfRows, numOfAlignedElements));
+            tableInfo.DataOffset = AlignUp(offset, ColumnAlignment);
+            offset = tableInfo.DataOffset + static_cast<std::uint64_t>(tableInfo.RowStride) * tableInfo.NumOfColumns * tableInfo.ElementSize;
+        }
+    }
+
+    void WriteBinaryTablesHeader(std::ostream& out, const std::vector<BinaryTableInfo>& tableInfos) {
+        FileHeader fileHeader{{}, FormatVersion, static_cast<std::uint32_t>(tableInfos.size())};
+        std::ranges::copy(Magic, fileHeader.Magic);
+        WriteBinaryValue(out, fileHeader);
+
+        for (const auto& tableInfo : tableInfos) {
+            WriteBinaryValue(out, TableHeader{
+                static_cast<std::uint32_t>(tableInfo.Type), static_cast<std::uint32_t>(tableInfo.ElementSize),
+                tableInfo.NumOfRows, tableInfo.NumOfColumns, tableInfo.RowStride, tableInfo.DataOffset,
+                static_cast<std::uint32_t>(tableInfo.ColumnNames.size()), 0});
+        }
+
+        for (const auto& tableInfo : tableInfos) {
+            for (const auto& columnName : tableInfo.ColumnNames) {
+                WriteBinaryValue(out, static_cast<std::uint32_t>(columnName.size()));
+                out.write(columnName.data(), static_cast<std::streamsize>(columnName.size()));
+            }
+        }
+    }
+
+    std::vector<BinaryTableInfo> ReadBinaryTablesHeader(const MappedFile& file) {
+        BinaryReader reader(file);
+
+        const auto fileHeader = reader.Read<FileHeader>();
+        if (std::string_view(fileHeader.Magic, sizeof(fileHeader.Magic)) != Magic)
+            throw std::invalid_argument("File is not a binary table file");
+
+        if (fileHeader.Version != FormatVersion)
+            throw std::invalid_argument("Unsupported binary table file version");
+
+        std::vector<TableHeader> tableHeaders;
+        for (std::uint32_t tableIndex = 0; tableIndex < fileHeader.NumOfTables; ++tableIndex)
+            tableHeaders.push_back(reader.Read<TableHeader>());
+
+        std::vector<BinaryTableInfo> tableInfos;
+        for (const auto& tableHeader : tableHeaders) {
+            constexpr auto maxSize = std::numeric_limits<int>::max();
+            const auto type = static_cast<ElementType>(tableHeader.Type);
+            if (GetElementTypeSize(type) == 0 || GetElementTypeSize(type) != tableHeader.ElementSize)
+                throw std::invalid_argument("Unknown type of binary table elements");
+
+            if (tableHeader.NumOfRows < 0 || tableHeader.NumOfColumns < 0 || tableHeader.RowStride < tableHeader.NumOfRows
+                || tableHeader.RowStride > maxSize || tableHeader.NumOfColumns > maxSize
+                || (tableHeader.NumOfColumnNames != 0 && tableHeader.NumOfColumnNames != tableHeader.NumOfColumns))
+            {
+                throw std::invalid_argument("Invalid shape of binary table");
+            }
+
+            const auto dataSize = static_cast<std::uint64_t>(tableHeader.RowStride) * tableHeader.NumOfColumns * tableHeader.ElementSize;
+            if (tableHeader.DataOffset % ColumnAlignment != 0 || tableHeader.DataOffset > file.GetSize() || dataSize > file.GetSize() - tableHeader.DataOffset)
+                throw std::invalid_argument("Binary table data is out of file");
+
+            BinaryTableInfo tableInfo{type, tableHeader.ElementSize, static_cast<int>(tableHeader.NumOfRows), static_cast<int>(tableHeader.NumOfColumns),
+                                      static_cast<int>(tableHeader.RowStride), tableHeader.DataOffset, {}};
+            for (std::uint32_t columnIndex = 0; columnIndex < tableHeader.NumOfColumnNames; ++columnIndex)
+                tableInfo.ColumnNames.emplace_back(reader.ReadBytes(reader.Read<std::uint32_t>()));
+
+            tableInfos.push_back(std::move(tableInfo));
+        }
+
+        return tableInfos;
+    }
+
+    std::vector<std::string> LoadColumnNamesFromBinaryFile(const std::string& fileName, int tableIndex) {
+        const auto tableInfos = ReadBinaryTablesHeader(MappedFile(fileName));
+        if (tableIndex < 0 || tableIndex >= std::ssize(tableInfos))
+            throw std::out_of_range("Table index out of range");
+
+        return tableInfos[tableIndex].ColumnNames;
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef DECISION_TREE_2_BINARYTABLEUTILS_H
+#define DECISION_TREE_2_BINARYTABLEUTILS_H
+
+#include <DataContainers/Table.h>
+#include <DataContainers/Utils/MappedFile.h>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/// Binary columnar file of one or more tables in native byte order:
+/// file header, table headers, column names, then every table column-major with 64-byte aligned columns
+namespace DataContainers::BinaryTableUtils {
+    constexpr std::uint32_t FormatVersion = 1;
+    constexpr std::size_t ColumnAlignment = 64;
+
+    enum class ElementType : std::uint32_t {
+        Float32 = 1,
+        Float64 = 2,
+        Int32 = 3,
+        Int64 = 4
+    };
+
+    template<class StoredType>
+    [[nodiscard]] constexpr ElementType GetElementType() {
+        if constexpr (std::is_same_v<StoredType, float>)
+            return ElementType::Float32;
+        else if constexpr (std::is_same_v<StoredType, double>)
+            return ElementType::Float64;
+        else if constexpr (std::is_same_v<StoredType, std::int32_t>)
+            return ElementType::Int32;
+        else if constexpr (std::is_same_v<StoredType, std::int64_t>)
+            return ElementType::Int64;
+        else
+            static_assert(sizeof(StoredType) == 0, "Type can not be stored in a binary table file");
+    }
+
+    struct BinaryTableInfo {
+        ElementType Type = ElementType::Float64;
+        std::size_t ElementSize = 0;
+        int NumOfRows = 0;
+        int NumOfColumns = 0;
+        int RowStride = 0;                          ///< Number of elements between the beginnings of neighbouring columns
+        std::uint64_t DataOffset = 0;               ///< Offset of the first column from the beginning of the file
+        std::vector<std::string> ColumnNames;       ///< Empty if the table was saved without column names
+    };
+
+    /// Fills RowStride and DataOffset of every table
+    void LayOutBinaryTables(std::vector<BinaryTableInfo>& tableInfos);
+    void WriteBinaryTablesHeader(std::ostream& out, const std::vector<BinaryTableInfo>& tableInfos);
+    [[nodiscard]] std::vector<BinaryTableInfo> ReadBinaryTablesHeader(const MappedFile& file);
+
+    template<class StoredType>
+    void SaveTablesToBinaryFile(
+        const std::string& fileName,
+        std::span<const Table<StoredType>* const> tables,
+        std::span<const std::vector<std::string>> columnNames = {})
+    {
+        if (!columnNames.empty() && columnNames.size() != tables.size())
+            throw std::invalid_argument("Column names are not given for every table");
+
+        std::vector<BinaryTableInfo> tableInfos;
+        for (int tableIndex = 0; tableIndex < std::ssize(tables); ++tableIndex) {
+            const auto& table = *tables[tableIndex];
+            auto names = columnNames.empty() ? std::vector<std::string>{} : columnNames[tableIndex];
+            if (!names.empty() && std::ssize(names) != table.GetNumOfColumns())
+                throw std::invalid_argument("Number of column names is not equal to number of columns");
+
+            tableInfos.push_back({GetElementType<StoredType>(), sizeof(StoredType), table.GetNumOfRows(), table.GetNumOfColumns(), 0, 0, std::move(names)});
+        }
+        LayOutBinaryTables(tableInfos);
+
+        std::ofstream out(fileName, std::ios::binary);
+        if (!out.is_open())
+            throw std::invalid_argument("Failed to open file");
+
+        WriteBinaryTablesHeader(out, tableInfos);
+        for (int tableIndex = 0; tableIndex < std::ssize(tables); ++tableIndex) {
+            const auto& tableInfo = tableInfos[tableIndex];
+            const std::vector<StoredType> columnPadding(tableInfo.RowStride - tableInfo.NumOfRows);
+
+            out.seekp(static_cast<std::streamoff>(tableInfo.DataOffset));
+            for (int columnIndex = 0; columnIndex < tableInfo.NumOfColumns; ++columnIndex) {
+                const auto column = tables[tableIndex]->GetColumnSpan(columnIndex);
+                out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size_bytes()));
+                out.write(reinterpret_cast<const char*>(columnPadding.data()), static_cast<std::streamsize>(columnPadding.size() * sizeof(StoredType)));
+            }
+        }
+
+        if (!out)
+            throw std::runtime_error("Failed to write binary table file");
+    }
+
+    template<class StoredType>
+    void SaveTableToBinaryFile(const Table<StoredType>& table, const std::string& fileName, const std::vector<std::string>& columnNames = {}) {
+        const std::array tables{&table};
+        SaveTablesToBinaryFile<StoredType>(fileName, tables, std::span(&columnNames, 1));
+    }
+
+    /// Maps the file and returns its tables reading straight from the mapping, the mapping lives as long as any of the tables
+    template<class StoredType>
+    [[nodiscard]] std::vector<Table<StoredType>> LoadTablesFromBinaryFile(const std::string& fileName) {
+        auto file = std::make_shared<const MappedFile>(fileName);
+
+        std::vector<Table<StoredType>> tables;
+        for (const auto& tableInfo : ReadBinaryTablesHeader(*file)) {
+            if (tableInfo.Type != GetElementType<StoredType>() || tableInfo.ElementSize != sizeof(StoredType))
+                throw std::invalid_argument("Type of binary table elements does not match");
+
+            tables.emplace_back(file, reinterpret_cast<const StoredType*>(file->GetData() + tableInfo.DataOffset),
+                                tableInfo.NumOfRows, tableInfo.NumOfColumns, tableInfo.RowStride);
+        }
+
+        return tables;
+    }
+
+    template<class StoredType>
+    [[nodiscard]] Table<StoredType> LoadTableFromBinaryFile(const std::string& fileName, int tableIndex = 0) {
+        auto tables = LoadTablesFromBinaryFile<StoredType>(fileName);
+        if (tableIndex < 0 || tableIndex >= std::ssize(tables))
+            throw std::out_of_range("Table index out of range");
+
+        return std::move(tables[tableIndex]);
+    }
+
+    [[nodiscard]] std::vector<std::string> LoadColumnNamesFromBinaryFile(const std::string& fileName, int tableIndex = 0);
+}
+
+#endif
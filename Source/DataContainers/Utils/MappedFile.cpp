@@ -0,0 +1,61 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace DataContainers {
+    MappedFile::MappedFile(const std::string& fileName) {
+        const int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+        if (fileDescriptor == -1)
+            throw std::invalid_argument("Failed to open file");
+
+        struct stat fileStatus{};
+        if (fstat(fileDescriptor, &fileStatus) == -1) {
+            close(fileDescriptor);
+            throw std::invalid_argument("Failed to get file size");
+        }
+
+        m_size = static_cast<std::size_t>(fileStatus.st_size);
+        if (m_size > 0) {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if (data == MAP_FAILED) {
+                close(fileDescriptor);
+                throw std::invalid_argument("Failed to map file");
+            }
+
+            madvise(data, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const std::byte*>(data);
+        }
+
+        close(fileDescriptor);
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0)) {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        Unmap();
+    }
+
+    void MappedFile::Unmap() {
+        if (m_data != nullptr)
+            munmap(const_cast<std::byte*>(m_data), m_size);
+
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
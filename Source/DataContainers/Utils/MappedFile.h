@@ -0,0 +1,35 @@
+#ifndef DECISION_TREE_2_MAPPEDFILE_H
+#define DECISION_TREE_2_MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace DataContainers {
+    /// Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& fileName);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        ~MappedFile();
+
+        [[nodiscard]] const std::byte* GetData() const { return m_data; }
+        [[nodiscard]] std::size_t GetSize() const { return m_size; }
+        [[nodiscard]] std::string_view GetContent() const { return {reinterpret_cast<const char*>(m_data), m_size}; }
+
+    private:
+        void Unmap();
+
+    private:
+        const std::byte* m_data = nullptr;    ///< Beginning of the mapping, nullptr for an empty file
+        std::size_t m_size = 0;               ///< Size of the file in bytes
+    };
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include "TableUtils.h"
+#include <algorithm>
+
+namespace DataContainers::TableUtils {
+    std::vector<int> GetTableColumnIndexes(std::string_view header, const std::unordered_set<std::string>& ignoredColumns, char delim) {
+        const auto columnNames = header
+            | std::views::split(delim)
+            | std::views::transform([](auto&& rawName) { return std::string(StringUtils::TrimView(std::string_view(rawName))); })
+            | RangesUtils::to_vector;
+
+        if (std::ssize(ignoredColumns) >= std::ssize(columnNames))
+            throw std::invalid_argument("The number of columns to be ignored is greater or equal than the total number of columns");
+
+        std::vector<int> tableColumnIndexes(columnNames.size(), -1);
+        for (int fileColumnIndex = 0, tableColumnIndex = 0; fileColumnIndex < std::ssize(columnNames); ++fileColumnIndex)
+            if (!ignoredColumns.contains(columnNames[fileColumnIndex]))
+                tableColumnIndexes[fileColumnIndex] = tableColumnIndex++;
+
+        return tableColumnIndexes;
+    }
+
+    std::vector<std::string_view> SplitIntoLineAlignedChunks(std::string_view text, std::size_t chunkSize) {
+        std::vector<std::string_view> chunks;
+        for (std::size_t chunkBegin = 0; chunkBegin < text.size();) {
+            const auto chunkLastLineEnd = text.find('\n', std::min(chunkBegin + chunkSize, text.size()) - 1);
+            const auto chunkEnd = chunkLastLineEnd == std::string_view::npos ? text.size() : chunkLastLineEnd + 1;
+            chunks.push_back(text.substr(chunkBegin, chunkEnd - chunkBegin));
+            chunkBegin = chunkEnd;
+        }
+
+        return chunks;
+    }
+
+    int CountNonBlankLines(std::string_view text) {
+        int numOfLines = 0;
+        for (std::size_t lineBegin = 0; lineBegin < text.size();) {
+            const auto lineEnd = std::min(text.find('\n', lineBegin), text.size());
+            numOfLines += !IsBlankLine(text.substr(lineBegin, lineEnd - lineBegin));
+            lineBegin = lineEnd + 1;
+        }
+
+        return numOfLines;
+    }
+
+    bool IsBlankLine(std::string_view line) {
+        return line.empty() || line == "\r";
+    }
+}
@@ -2,8 +2,12 @@
 #define DECISION_TREE_2_TABLEUTILS_H
 
 #include <DataContainers/Table.h>
+#include <DataContainers/Utils/MappedFile.h>
 #include <string>
+#include <string_view>
 #include <unordered_set>
+#include <charconv>
+#include <numeric>
 #include <RangesUtils/ToVectorRangeAdaptor.h>
 #include <StringUtils/Trim.h>
 #include <sstream>
@@ -12,48 +16,142 @@
 #include <type_traits>
 
 namespace DataContainers::TableUtils {
+    constexpr std::size_t CsvChunkSize = 1 << 20;   ///< Approximate number of bytes parsed by one task
+
+    [[nodiscard]] std::vector<int> GetTableColumnIndexes(std::string_view header, const std::unordered_set<std::string>& ignoredColumns, char delim);
+    [[nodiscard]] std::vector<std::string_view> SplitIntoLineAlignedChunks(std::string_view text, std::size_t chunkSize);
+    [[nodiscard]] int CountNonBlankLines(std::string_view text);
+    [[nodiscard]] bool IsBlankLine(std::string_view line);
+
     template<class StoredType>
-    Table<StoredType> LoadTableFromFile(const std::string &fileName, const std::unordered_set<std::string> &ignoredColumns, char delim = ',') {
-        std::ifstream inp(fileName);
-        if (!inp.is_open())
-            throw std::invalid_argument("Failed to open file");
-
-        const auto columnNames = [&inp, delim](){
-            std::string columnNamesStr;
-            std::getline(inp, columnNamesStr);
-            return columnNamesStr
-                   | std::views::split(delim)
-                   | std::views::transform([](const std::span<char> &sp) { return StringUtils::TrimCopy(std::string(sp.begin(), sp.end())); })
-                   | RangesUtils::to_vector;
-        }();
-
-        if (std::ssize(ignoredColumns) >= std::ssize(columnNames))
-            throw std::invalid_argument("The number of columns to be ignored is greater or equal than the total number of columns");
-
-        Table<StoredType> table;
-        table.SetNumOfColumns(std::ssize(columnNames) - std::ssize(ignoredColumns));
-
-        for (std::string line; getline(inp, line);)
-        {
-            if (line.empty())
+    [[nodiscard]] bool ParseCsvChunk(std::string_view chunk, char delim, const std::vector<int>& tableColumnIndexes,
+                                     const std::vector<std::span<StoredType>>& tableColumns, int firstRowIndex)
+    {
+        int rowIndex = firstRowIndex;
+        for (std::size_t lineBegin = 0; lineBegin < chunk.size(); ++rowIndex) {
+            const auto lineEnd = std::min(chunk.find('\n', lineBegin), chunk.size());
+            const auto line = chunk.substr(lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
+            if (IsBlankLine(line)) {
+                --rowIndex;
                 continue;
+            }
+
+            int fileColumnIndex = 0;
+            for (std::size_t cellBegin = 0; cellBegin <= line.size(); ++fileColumnIndex) {
+                const auto cellEnd = std::min(line.find(delim, cellBegin), line.size());
+                const auto cell = StringUtils::TrimView(line.substr(cellBegin, cellEnd - cellBegin));
+                cellBegin = cellEnd + 1;
+
+                if (fileColumnIndex >= std::ssize(tableColumnIndexes))
+                    return false;
+
+                const int tableColumnIndex = tableColumnIndexes[fileColumnIndex];
+                if (tableColumnIndex == -1)
+                    continue;
+
+                // Empty cells and a leading '+' are read the way the stream-based loader reads them
+                if (cell.empty()) {
+                    tableColumns[tableColumnIndex][rowIndex] = StoredType{};
+                    continue;
+                }
+
+                const auto number = cell.starts_with('+') ? cell.substr(1) : cell;
+                const auto [parseEnd, errorCode] = std::from_chars(number.data(), number.data() + number.size(), tableColumns[tableColumnIndex][rowIndex]);
+                if (errorCode != std::errc() || parseEnd != number.data() + number.size())
+                    return false;
+            }
+
+            if (fileColumnIndex != std::ssize(tableColumnIndexes))
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Memory-maps a CSV file and parses newline-aligned chunks of it in parallel straight into the table columns
+    template<class StoredType>
+    requires std::is_arithmetic_v<StoredType>
+    Table<StoredType> LoadTableFromMappedFile(const std::string& fileName, const std::unordered_set<std::string>& ignoredColumns, char delim = ',') {
+        const MappedFile file(fileName);
+        const auto content = file.GetContent();
 
-            auto data = line
-                        | std::views::split(delim)
-                        | std::views::filter([index = 0, &ignoredColumns, &columnNames](auto&&) mutable { return !ignoredColumns.contains(columnNames[index++]); })
-                        | std::views::transform([](const std::span<char>& rawObj) {
-                            std::stringstream ss;
-                            ss << std::string_view(rawObj);
-                            StoredType obj;
-                            ss >> obj;
-                            return obj;
-                        });
-            table.PushBackRow(data);
+        const auto headerEnd = std::min(content.find('\n'), content.size());
+        const auto tableColumnIndexes = GetTableColumnIndexes(content.substr(0, headerEnd), ignoredColumns, delim);
+        const auto chunks = SplitIntoLineAlignedChunks(content.substr(std::min(headerEnd + 1, content.size())), CsvChunkSize);
+
+        std::vector<int> chunkFirstRowIndexes(chunks.size() + 1, 0);
+        #pragma omp parallel for schedule(dynamic)
+        for (int chunkIndex = 0; chunkIndex < std::ssize(chunks); ++chunkIndex)
+            chunkFirstRowIndexes[chunkIndex + 1] = CountNonBlankLines(chunks[chunkIndex]);
+        std::partial_sum(chunkFirstRowIndexes.begin(), chunkFirstRowIndexes.end(), chunkFirstRowIndexes.begin());
+
+        Table<StoredType> table(chunkFirstRowIndexes.back(), std::ranges::count_if(tableColumnIndexes, [](int i){ return i != -1; }));
+        std::vector<std::span<StoredType>> tableColumns;
+        for (int columnIndex = 0; columnIndex < table.GetNumOfColumns(); ++columnIndex)
+            tableColumns.push_back(table.GetColumnSpan(columnIndex));
+
+        bool isParsingFailed = false;
+        #pragma omp parallel for schedule(dynamic)
+        for (int chunkIndex = 0; chunkIndex < std::ssize(chunks); ++chunkIndex) {
+            if (!ParseCsvChunk(chunks[chunkIndex], delim, tableColumnIndexes, tableColumns, chunkFirstRowIndexes[chunkIndex])) {
+                #pragma omp atomic write
+                isParsingFailed = true;
+            }
         }
 
+        if (isParsingFailed)
+            throw std::invalid_argument("Failed to parse table file");
+
         return table;
     }
 
+    template<class StoredType>
+    Table<StoredType> LoadTableFromFile(const std::string &fileName, const std::unordered_set<std::string> &ignoredColumns, char delim = ',') {
+        if constexpr (std::is_arithmetic_v<StoredType>) {
+            return LoadTableFromMappedFile<StoredType>(fileName, ignoredColumns, delim);
+        } else {
+            std::ifstream inp(fileName);
+            if (!inp.is_open())
+                throw std::invalid_argument("Failed to open file");
+
+            const auto columnNames = [&inp, delim](){
+                std::string columnNamesStr;
+                std::getline(inp, columnNamesStr);
+                return columnNamesStr
+                       | std::views::split(delim)
+                       | std::views::transform([](const std::span<char> &sp) { return StringUtils::TrimCopy(std::string(sp.begin(), sp.end())); })
+                       | RangesUtils::to_vector;
+            }();
+
+            if (std::ssize(ignoredColumns) >= std::ssize(columnNames))
+                throw std::invalid_argument("The number of columns to be ignored is greater or equal than the total number of columns");
+
+            Table<StoredType> table;
+            table.SetNumOfColumns(std::ssize(columnNames) - std::ssize(ignoredColumns));
+
+            for (std::string line; getline(inp, line);)
+            {
+                if (line.empty())
+                    continue;
+
+                auto data = line
+                            | std::views::split(delim)
+                            | std::views::filter([index = 0, &ignoredColumns, &columnNames](auto&&) mutable { return !ignoredColumns.contains(columnNames[index++]); })
+                            | std::views::transform([](const std::span<char>& rawObj) {
+                                std::stringstream ss;
+                                ss << std::string_view(rawObj);
+                                StoredType obj;
+                                ss >> obj;
+                                return obj;
+                            });
+                table.PushBackRow(data);
+            }
+
+            return table;
+        }
+    }
+
     template<class StoredType, std::invocable<int, int> Func>
     Table<StoredType> LoadTableFromArray(StoredType* array, int numOfRows, int numOfColumns, Func getElementIndexInArray) {
         Table<StoredType> table(numOfRows, numOfColumns);
@@ -0,0 +1,66 @@
+#include "CompiledRegressionModel.h"
+#include <stdexcept>
+#include <dlfcn.h>
+#include <MachineLearning/Utils/BatchPredictionUtils.h>
+#include <MachineLearning/Utils/CodeGenerationUtils.h>
+
+namespace MachineLearning::CompiledModels {
+    CompiledRegressionModel::CompiledRegressionModel(const std::string& sharedLibraryFileName)
+        : m_sharedLibraryHandle(dlopen(sharedLibraryFileName.c_str(), RTLD_NOW | RTLD_LOCAL))
+    {
+        if (m_sharedLibraryHandle == nullptr)
+            throw std::invalid_argument("Failed to load compiled model: " + std::string(dlerror()));
+
+        try {
+            using namespace CodeGenerationUtils;
+            m_numOfFeatures = reinterpret_cast<int (*)()>(LoadSymbol(CompiledModelSymbols::NumOfFeatures))();
+            m_numOfPredictedValues = reinterpret_cast<int (*)()>(LoadSymbol(CompiledModelSymbols::NumOfPredictedValues))();
+            m_predict = reinterpret_cast<PredictFunction>(LoadSymbol(CompiledModelSymbols::Predict));
+            m_predictBlock = reinterpret_cast<PredictBlockFunction>(LoadSymbol(CompiledModelSymbols::PredictBlock));
+        }
+        catch (...) {
+            dlclose(m_sharedLibraryHandle);
+            throw;
+        }
+    }
+
+    CompiledRegressionModel::~CompiledRegressionModel() {
+        dlclose(m_sharedLibraryHandle);
+    }
+
+    void CompiledRegressionModel::Fit(const Datasets::SupervisedLearningDatasetView<double>&) {
+        throw std::logic_error("Compiled regression model can not be fitted");
+    }
+
+    std::unique_ptr<RegressionModel> CompiledRegressionModel::CreateUnfittedCopy() const {
+        throw std::logic_error("Compiled regression model can not be fitted");
+    }
+
+    std::vector<double> CompiledRegressionModel::Predict(const std::vector<double>& features) const {
+        if (std::ssize(features) < m_numOfFeatures)
+            throw std::invalid_argument("Number of features is less than the model uses");
+
+        std::vector<double> res(m_numOfPredictedValues);
+        m_predict(features.data(), res.data());
+
+        return res;
+    }
+
+    DataContainers::Table<double> CompiledRegressionModel::Predict(const DataContainers::TableView<double>& features) const {
+        if (features.GetNumOfColumns() < m_numOfFeatures)
+            throw std::invalid_argument("Number of features is less than the model uses");
+
+        return BatchPredictionUtils::PredictByRowBlocks(features, m_numOfPredictedValues,
+            [this](const BatchPredictionUtils::FeaturesBlock& featuresBlock, std::span<double> predictions) {
+                m_predictBlock(featuresBlock.Values.data(), featuresBlock.NumOfRows, predictions.data());
+            });
+    }
+
+    void* CompiledRegressionModel::LoadSymbol(const char* symbolName) const {
+        auto* symbol = dlsym(m_sharedLibraryHandle, symbolName);
+        if (symbol == nullptr)
+            throw std::invalid_argument("Compiled model does not export " + std::string(symbolName));
+
+        return symbol;
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef DECISION_TREE_2_COMPILEDREGRESSIONMODEL_H
+#define DECISION_TREE_2_COMPILEDREGRESSIONMODEL_H
+
+#include <string>
+#include <MachineLearning/RegressionModel.h>
+
+namespace MachineLearning::CompiledModels {
+    class CompiledRegressionModel final : public RegressionModel {
+    public:
+        explicit CompiledRegressionModel(const std::string& sharedLibraryFileName);
+
+        CompiledRegressionModel(const CompiledRegressionModel&) = delete;
+        CompiledRegressionModel& operator=(const CompiledRegressionModel&) = delete;
+
+        ~CompiledRegressionModel() override;
+
+        void Fit(const Datasets::SupervisedLearningDatasetView<double>& dataset) override;
+
+        [[nodiscard]] std::vector<double> Predict(const std::vector<double>& features) const override;
+        [[nodiscard]] DataContainers::Table<double> Predict(const DataContainers::TableView<double>& features) const override;
+
+        [[nodiscard]] std::unique_ptr<RegressionModel> CreateUnfittedCopy() const override;
+
+    private:
+        using PredictFunction = void (*)(const double* features, double* predictions);
+        using PredictBlockFunction = void (*)(const double* columnMajorFeatures, int numOfRows, double* predictions);
+
+        [[nodiscard]] void* LoadSymbol(const char* symbolName) const;
+
+    private:
+        void* m_sharedLibraryHandle = nullptr;
+        int m_numOfFeatures = 0;
+        int m_numOfPredictedValues = 0;
+        PredictFunction m_predict = nullptr;
+        PredictBlockFunction m_predictBlock = nullptr;
+    };
+}
+
+#endif
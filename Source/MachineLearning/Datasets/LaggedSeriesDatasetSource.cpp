@@ -0,0 +1,44 @@
+#include "LaggedSeriesDatasetSource.h"
+#include <stdexcept>
+
+namespace MachineLearning::Datasets {
+    LaggedSeriesDatasetSource::LaggedSeriesDatasetSource(DataContainers::Table<double> series, int featuresLag, int observationsLag)
+        : c_featuresLag(featuresLag)
+        , c_observationsLag(observationsLag)
+        , m_series(std::move(series))
+    {
+        if (featuresLag <= 0)
+            throw std::invalid_argument("Features lag is less than or equal to zero");
+
+        if (observationsLag <= 0)
+            throw std::invalid_argument("Observations lag is less than or equal to zero");
+
+        if (featuresLag + observationsLag > m_series.GetNumOfRows())
+            throw std::invalid_argument("Observations or Features lag is too long");
+    }
+
+    int LaggedSeriesDatasetSource::GetNumOfRows() const {
+        return m_series.GetNumOfRows() - c_featuresLag - c_observationsLag + 1;
+    }
+
+    void LaggedSeriesDatasetSource::ReadChunk(int firstRowIndex, int numOfRows, SupervisedLearningDataset<double>& chunk) const {
+        if (firstRowIndex < 0 || numOfRows < 0 || firstRowIndex + numOfRows > GetNumOfRows())
+            throw std::out_of_range("Chunk is out of dataset");
+
+        chunk.Features.SetNumOfColumns(GetNumOfFeatures());
+        chunk.Features.SetNumOfRows(numOfRows);
+        chunk.Observations.SetNumOfColumns(GetNumOfObservations());
+        chunk.Observations.SetNumOfRows(numOfRows);
+
+        const int numOfSeriesColumns = m_series.GetNumOfColumns();
+        for (int lag = 0; lag < c_featuresLag + c_observationsLag; ++lag) {
+            auto& table = lag < c_featuresLag ? chunk.Features : chunk.Observations;
+            const int firstColumnIndex = (lag < c_featuresLag ? lag : lag - c_featuresLag) * numOfSeriesColumns;
+
+            for (int seriesColumnIndex = 0; seriesColumnIndex < numOfSeriesColumns; ++seriesColumnIndex) {
+                const auto seriesColumn = m_series.GetColumnSpan(seriesColumnIndex).subspan(firstRowIndex + lag, numOfRows);
+                std::ranges::copy(seriesColumn, table.GetColumnSpan(firstColumnIndex + seriesColumnIndex).begin());
+            }
+        }
+    }
+}
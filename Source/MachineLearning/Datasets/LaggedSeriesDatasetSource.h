@@ -0,0 +1,26 @@
+#ifndef DECISION_TREE_2_LAGGEDSERIESDATASETSOURCE_H
+#define DECISION_TREE_2_LAGGEDSERIESDATASETSOURCE_H
+
+#include <MachineLearning/Datasets/StreamingDatasetSource.h>
+
+namespace MachineLearning::Datasets {
+    /// Lag expansion of a series done chunk by chunk, rows are laid out as TimeSeriesForecastingUtils::SeriesToSupervised does.
+    /// A series loaded from a binary table file stays mapped, so only the chunks being read are resident
+    class LaggedSeriesDatasetSource final : public StreamingDatasetSource {
+    public:
+        LaggedSeriesDatasetSource(DataContainers::Table<double> series, int featuresLag, int observationsLag);
+
+        [[nodiscard]] int GetNumOfRows() const override;
+        [[nodiscard]] int GetNumOfFeatures() const override { return c_featuresLag * m_series.GetNumOfColumns(); }
+        [[nodiscard]] int GetNumOfObservations() const override { return c_observationsLag * m_series.GetNumOfColumns(); }
+
+        void ReadChunk(int firstRowIndex, int numOfRows, SupervisedLearningDataset<double>& chunk) const override;
+
+    private:
+        const int c_featuresLag;
+        const int c_observationsLag;
+        DataContainers::Table<double> m_series;
+    };
+}
+
+#endif
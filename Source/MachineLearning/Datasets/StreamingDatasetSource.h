@@ -0,0 +1,21 @@
+#ifndef DECISION_TREE_2_STREAMINGDATASETSOURCE_H
+#define DECISION_TREE_2_STREAMINGDATASETSOURCE_H
+
+#include <MachineLearning/Datasets/SupervisedLearningDataset.h>
+
+namespace MachineLearning::Datasets {
+    /// Supervised learning dataset which is read chunk by chunk and never has to be resident as a whole
+    class StreamingDatasetSource {
+    public:
+        [[nodiscard]] virtual int GetNumOfRows() const = 0;
+        [[nodiscard]] virtual int GetNumOfFeatures() const = 0;
+        [[nodiscard]] virtual int GetNumOfObservations() const = 0;
+
+        /// Replaces the chunk content with rows [firstRowIndex, firstRowIndex + numOfRows) of the dataset
+        virtual void ReadChunk(int firstRowIndex, int numOfRows, SupervisedLearningDataset<double>& chunk) const = 0;
+
+        virtual ~StreamingDatasetSource() = default;
+    };
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "DecisionStumpRegressor.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <MachineLearning/Utils/BatchPredictionUtils.h>
+
+namespace MachineLearning::DecisionTrees {
+    void DecisionStumpRegressor::Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) {
+        Fit(trainingDataset, {});
+    }
+
+    void DecisionStumpRegressor::Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset, std::span<const double> sampleWeights) {
+        Fit(trainingDataset, GetPresortedFeatures(trainingDataset.Features), sampleWeights);
+    }
+
+    void DecisionStumpRegressor::Fit(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        const PresortedFeatures& presortedFeatures,
+        std::span<const double> sampleWeights)
+    {
+        const auto& [features, observations] = trainingDataset;
+        const int numOfRows = features.GetNumOfRows();
+        const int numOfOutputs = observations.GetNumOfColumns();
+
+        if (presortedFeatures.NumOfRows != numOfRows || presortedFeatures.NumOfFeatures != features.GetNumOfColumns())
+            throw std::invalid_argument("Presorted features don't match the dataset");
+
+        if (!sampleWeights.empty() && std::ssize(sampleWeights) != numOfRows)
+            throw std::invalid_argument("Number of sample weights and rows don't coincide");
+
+        if (std::ranges::any_of(sampleWeights, [](double weight){ return !(weight >= 0.0); }))
+            throw std::invalid_argument("Sample weight is negative");
+
+        // Weighted observations are laid out by view row, so a scan reads every row it passes from one place
+        std::vector<double> rowWeights(numOfRows, 1.0);
+        std::vector<double> weightedObservations(static_cast<std::size_t>(numOfRows) * numOfOutputs);
+        std::vector<double> totalSums(numOfOutputs, 0.0);
+        double totalWeight = 0.0;
+        for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex) {
+            if (!sampleWeights.empty())
+                rowWeights[rowIndex] = sampleWeights[rowIndex];
+
+            for (int columnIndex = 0; columnIndex < numOfOutputs; ++columnIndex) {
+                const double value = rowWeights[rowIndex] * observations.AtUnchecked(rowIndex, columnIndex);
+                weightedObservations[rowIndex * numOfOutputs + columnIndex] = value;
+                totalSums[columnIndex] += value;
+            }
+            totalWeight += rowWeights[rowIndex];
+        }
+
+        if (!(totalWeight > 0.0))
+            throw std::invalid_argument("Training dataset has no rows of positive weight");
+
+        // Minimizing the squared error of the leaf means is maximizing the sum of squared leaf sums divided by leaf weights
+        double bestScore = std::transform_reduce(totalSums.begin(), totalSums.end(), 0.0, std::plus(),
+                                                 [totalWeight](double sum){ return sum * sum / totalWeight; });
+        std::vector<double> bestLeftSums;
+        double bestLeftWeight = 0.0;
+        double bestLowerValue = 0.0;
+        double bestUpperValue = 0.0;
+        m_featureIndex = FlatDecisionTree::LeafFeatureIndex;
+
+        std::vector<double> leftSums(numOfOutputs);
+        for (int featureIndex = 0; featureIndex < presortedFeatures.NumOfFeatures; ++featureIndex) {
+            const auto sortedRows = std::span(presortedFeatures.SortedRows).subspan(featureIndex * numOfRows, numOfRows);
+            const auto sortedValues = std::span(presortedFeatures.SortedValues).subspan(featureIndex * numOfRows, numOfRows);
+            std::ranges::fill(leftSums, 0.0);
+            double leftWeight = 0.0;
+            double previousValue = 0.0;
+
+            for (int i = 0; i < numOfRows; ++i) {
+                const int row = sortedRows[i];
+                if (rowWeights[row] == 0.0)
+                    continue;
+
+                if (leftWeight > 0.0 && sortedValues[i] > previousValue) {
+                    const double rightWeight = totalWeight - leftWeight;
+                    double score = 0.0;
+                    for (int columnIndex = 0; columnIndex < numOfOutputs; ++columnIndex) {
+                        const double rightSum = totalSums[columnIndex] - leftSums[columnIndex];
+                        score += leftSums[columnIndex] * leftSums[columnIndex] / leftWeight + rightSum * rightSum / rightWeight;
+                    }
+
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestLeftSums = leftSums;
+                        bestLeftWeight = leftWeight;
+                        bestLowerValue = previousValue;
+                        bestUpperValue = sortedValues[i];
+                        m_featureIndex = featureIndex;
+                    }
+                }
+
+                leftWeight += rowWeights[row];
+                for (int columnIndex = 0; columnIndex < numOfOutputs; ++columnIndex)
+                    leftSums[columnIndex] += weightedObservations[row * numOfOutputs + columnIndex];
+                previousValue = sortedValues[i];
+            }
+        }
+
+        m_numOfPredictedValues = numOfOutputs;
+        m_leafValues.resize(2 * numOfOutputs);
+        if (IsLeaf()) {
+            m_threshold = 0.0;
+            for (int columnIndex = 0; columnIndex < numOfOutputs; ++columnIndex)
+                m_leafValues[columnIndex] = m_leafValues[numOfOutputs + columnIndex] = totalSums[columnIndex] / totalWeight;
+            return;
+        }
+
+        // A midpoint rounded onto the greater value would send its rows to the left
+        const double midpoint = bestLowerValue / 2 + bestUpperValue / 2;
+        m_threshold = midpoint < bestUpperValue ? midpoint : bestLowerValue;
+        for (int columnIndex = 0; columnIndex < numOfOutputs; ++columnIndex) {
+            m_leafValues[columnIndex] = bestLeftSums[columnIndex] / bestLeftWeight;
+            m_leafValues[numOfOutputs + columnIndex] = (totalSums[columnIndex] - bestLeftSums[columnIndex]) / (totalWeight - bestLeftWeight);
+        }
+    }
+
+    std::vector<double> DecisionStumpRegressor::Predict(const std::vector<double>& features) const {
+        const auto leafValues = PredictValues(features);
+        return {leafValues.begin(), leafValues.end()};
+    }
+
+    DataContainers::Table<double> DecisionStumpRegressor::Predict(const DataContainers::TableView<double>& features) const {
+        return BatchPredictionUtils::PredictByRowBlocks(features, m_numOfPredictedValues,
+            [this](const BatchPredictionUtils::FeaturesBlock& featuresBlock, std::span<double> predictions) {
+                const auto featureColumn = IsLeaf() ? std::span<const double>()
+                                                    : std::span(featuresBlock.Values).subspan(m_featureIndex * featuresBlock.NumOfRows, featuresBlock.NumOfRows);
+
+                for (int rowIndex = 0; rowIndex < featuresBlock.NumOfRows; ++rowIndex)
+                    std::ranges::copy(GetLeafValues(!IsLeaf() && featureColumn[rowIndex] > m_threshold),
+                                      predictions.begin() + rowIndex * m_numOfPredictedValues);
+            });
+    }
+
+    std::unique_ptr<RegressionModel> DecisionStumpRegressor::CreateUnfittedCopy() const {
+        return std::make_unique<DecisionStumpRegressor>();
+    }
+
+    FlatDecisionTree DecisionStumpRegressor::ToFlatTree() const {
+        if (!IsFitted())
+            throw std::logic_error("Model is not fitted");
+
+        FlatDecisionTree tree(m_numOfPredictedValues);
+        if (IsLeaf()) {
+            tree.AddLeafNode(GetLeafValues(false));
+            return tree;
+        }
+
+        tree.AddSplitNode(m_featureIndex, m_threshold, 1);
+        tree.AddLeafNode(GetLeafValues(false));
+        tree.AddLeafNode(GetLeafValues(true));
+        return tree;
+    }
+
+    DecisionStumpRegressor DecisionStumpRegressor::CreateFromFlatTree(const FlatDecisionTree& tree) {
+        DecisionStumpRegressor stump;
+        stump.m_numOfPredictedValues = tree.GetNumOfPredictedValues();
+
+        if (tree.GetNumOfNodes() == 1 && tree.IsLeaf(0)) {
+            const auto leafValues = tree.GetLeafValues(0);
+            stump.m_leafValues.assign(leafValues.begin(), leafValues.end());
+            stump.m_leafValues.insert(stump.m_leafValues.end(), leafValues.begin(), leafValues.end());
+            return stump;
+        }
+
+        if (tree.GetNumOfNodes() != 3 || tree.IsLeaf(0) || !tree.IsLeaf(tree.GetLeftChildIndex(0)) || !tree.IsLeaf(tree.GetRightChildIndex(0)))
+            throw std::invalid_argument("Tree is not a decision stump");
+
+        stump.m_featureIndex = tree.GetFeatureIndex(0);
+        stump.m_threshold = tree.GetThreshold(0);
+        const auto leftLeafValues = tree.GetLeafValues(tree.GetLeftChildIndex(0));
+        const auto rightLeafValues = tree.GetLeafValues(tree.GetRightChildIndex(0));
+        stump.m_leafValues.assign(leftLeafValues.begin(), leftLeafValues.end());
+        stump.m_leafValues.insert(stump.m_leafValues.end(), rightLeafValues.begin(), rightLeafValues.end());
+        return stump;
+    }
+
+    DecisionStumpRegressor::PresortedFeatures DecisionStumpRegressor::GetPresortedFeatures(const DataContainers::TableView<double>& features) {
+        const int numOfRows = features.GetNumOfRows();
+        PresortedFeatures res{numOfRows, features.GetNumOfColumns(),
+                              std::vector<int>(static_cast<std::size_t>(numOfRows) * features.GetNumOfColumns()),
+                              std::vector<double>(static_cast<std::size_t>(numOfRows) * features.GetNumOfColumns())};
+
+        #pragma omp parallel for
+        for (int featureIndex = 0; featureIndex < features.GetNumOfColumns(); ++featureIndex) {
+            std::vector<double> featuresColumn(numOfRows);
+            features.GetColumn(featureIndex, featuresColumn.begin());
+
+            const auto sortedRows = std::span(res.SortedRows).subspan(featureIndex * numOfRows, numOfRows);
+            std::iota(sortedRows.begin(), sortedRows.end(), 0);
+            std::ranges::stable_sort(sortedRows, [&featuresColumn](int a, int b){ return featuresColumn[a] < featuresColumn[b]; });
+
+            const auto sortedValues = std::span(res.SortedValues).subspan(featureIndex * numOfRows, numOfRows);
+            std::ranges::transform(sortedRows, sortedValues.begin(), [&featuresColumn](int row){ return featuresColumn[row]; });
+        }
+
+        return res;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef DECISION_TREE_2_DECISIONSTUMPREGRESSOR_H
+#define DECISION_TREE_2_DECISIONSTUMPREGRESSOR_H
+
+#include <MachineLearning/RegressionModel.h>
+#include <MachineLearning/DecisionTrees/FlatDecisionTree.h>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace MachineLearning::DecisionTrees {
+    /// Depth-one tree for boosting: one compare of one feature picks the left or the right leaf
+    class DecisionStumpRegressor final : public RegressionModel {
+    public:
+        /// Rows of a dataset sorted by every feature along with their feature values, sorted once for all stumps fitted on the dataset
+        struct PresortedFeatures {
+            int NumOfRows = 0;
+            int NumOfFeatures = 0;
+            std::vector<int> SortedRows;        ///< View row indexes sorted by each feature in turn, NumOfRows per feature
+            std::vector<double> SortedValues;   ///< Feature values in the order of SortedRows
+        };
+
+        DecisionStumpRegressor() = default;
+
+        void Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) override;
+        /// Row i of the dataset counts as sampleWeights[i] rows, rows of zero weight are left out and empty weights fit every row once
+        void Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset, std::span<const double> sampleWeights);
+        /// Finds the split in one pass of prefix sums over the rows presorted by each feature
+        void Fit(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            const PresortedFeatures& presortedFeatures,
+            std::span<const double> sampleWeights);
+
+        [[nodiscard]] std::vector<double> Predict(const std::vector<double>& features) const override;
+        [[nodiscard]] DataContainers::Table<double> Predict(const DataContainers::TableView<double>& features) const override;
+
+        template<std::ranges::random_access_range Range>
+        [[nodiscard]] std::span<const double> PredictValues(const Range& featureRange) const {
+            return GetLeafValues(!IsLeaf() && std::ranges::begin(featureRange)[m_featureIndex] > m_threshold);
+        }
+
+        [[nodiscard]] std::unique_ptr<RegressionModel> CreateUnfittedCopy() const override;
+
+        [[nodiscard]] bool IsFitted() const { return m_numOfPredictedValues > 0; }
+        [[nodiscard]] bool IsLeaf() const { return m_featureIndex == FlatDecisionTree::LeafFeatureIndex; }
+        [[nodiscard]] int GetFeatureIndex() const { return m_featureIndex; }
+        [[nodiscard]] double GetThreshold() const { return m_threshold; }
+        [[nodiscard]] int GetNumOfPredictedValues() const { return m_numOfPredictedValues; }
+        /// Values of the right leaf for rows whose feature is greater than the threshold, of the left one otherwise
+        [[nodiscard]] std::span<const double> GetLeafValues(bool isRightLeaf) const {
+            return std::span(m_leafValues).subspan(isRightLeaf * m_numOfPredictedValues, m_numOfPredictedValues);
+        }
+
+        /// The same stump as a flat tree, e.g. to be saved or compiled along with other trees
+        [[nodiscard]] FlatDecisionTree ToFlatTree() const;
+        /// Throws unless the tree is a single leaf or one split over two leaves
+        [[nodiscard]] static DecisionStumpRegressor CreateFromFlatTree(const FlatDecisionTree& tree);
+
+        [[nodiscard]] static PresortedFeatures GetPresortedFeatures(const DataContainers::TableView<double>& features);
+
+    private:
+        int m_featureIndex = FlatDecisionTree::LeafFeatureIndex;
+        double m_threshold = 0.0;
+        int m_numOfPredictedValues = 0;
+        std::vector<double> m_leafValues;       ///< Left leaf values followed by the right ones, the same twice for a single leaf
+    };
+}
+
+#endif
@@ -1,226 +1,1057 @@
 #include "DecisionTreeRegressor.h"
 #include <numeric>
 #include <algorithm>
+#include <optional>
+#include <deque>
+#include <array>
 #include <cmath>
-#include <RandomGenerators/ThreadSafeRandom.h>
+#include <cassert>
+#include <functional>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <tbb/parallel_for.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <RandomGenerators/PhiloxRandom.h>
 #include <RangesUtils/ToVectorRangeAdaptor.h>
+#include <MachineLearning/Utils/BatchPredictionUtils.h>
+#include <MachineLearning/Utils/ModelSerializationUtils.h>
 
 namespace {
     constexpr int WindowSize = 2;
+    constexpr int MaxNumOfQuantizationSamples = 1 << 18;
+    constexpr int MinNumOfRowsPerTask = 1 << 11;        ///< Smaller nodes grow both subtrees and search splits on their own thread
+    constexpr int HistogramRowBlockSize = 1 << 15;      ///< Least number of rows accumulated into one partial histogram of a feature
+    constexpr int MaxNumOfHistogramBlocks = 8;          ///< Larger nodes make their row blocks longer rather than allocate more partial histograms
+
+    /// Rows weigh one when no weights are given
+    double GetRowWeight(std::span<const double> rowWeights, int row) {
+        return rowWeights.empty() ? 1.0 : rowWeights[row];
+    }
 }
 
 namespace MachineLearning::DecisionTrees {
-    DecisionTreeRegressor::DecisionTreeRegressor(int maxDepth, int minSampleSize, double proportionOfFeaturesUsed, int numOfAvailableThreads)
+    struct DecisionTreeRegressor::SplitScratch {
+        std::vector<double> MeanObservations;
+        std::vector<double> FeaturesColumn;
+        std::vector<int> RowIndexes;
+        std::vector<double> UniqueValues;
+        std::vector<double> MovingAverage;
+        std::vector<double> LeftMeanSums;
+        std::vector<double> RightMeanSums;
+        std::vector<std::span<const double>> ObservationsColumns;
+        std::vector<double> BinWeights;
+        std::vector<double> BinMeanSums;
+        std::vector<int> RightRows;
+    };
+
+    /// A thread may pick up another node's task whenever it waits for parallel work, so scratch is never held across such a wait.
+    /// Rows of a node are one contiguous range of the row buffers, which the node partitions in place between its children
+    struct DecisionTreeRegressor::FitContext {
+        const QuantizedFeatures* Quantized = nullptr;
+        std::vector<int> Rows;                  ///< Table row indexes, shared by the features and observations views
+        std::vector<int> SortedRows;            ///< Table row indexes sorted by each feature in turn, Rows.size() per feature
+        std::vector<double> RowWeights;         ///< Weights indexed by table row, empty when every row weighs one
+        tbb::enumerable_thread_specific<std::deque<BuildNode>> NodeArenas;
+        tbb::enumerable_thread_specific<SplitScratch> SplitScratches;
+        tbb::enumerable_thread_specific<std::vector<NodeHistogram>> SpareHistograms;     ///< Histograms of finished nodes, whose buffers are reused
+
+        [[nodiscard]] std::span<int> GetNodeRows(int firstRowIndex, int numOfRows) {
+            return std::span(Rows).subspan(firstRowIndex, numOfRows);
+        }
+
+        [[nodiscard]] std::span<int> GetNodeSortedRows(int featureIndex, int firstRowIndex, int numOfRows) {
+            return std::span(SortedRows).subspan(featureIndex * Rows.size() + firstRowIndex, numOfRows);
+        }
+
+        [[nodiscard]] double GetWeightOfRows(std::span<const int> rows) const {
+            if (RowWeights.empty())
+                return std::ssize(rows);
+
+            return std::accumulate(rows.begin(), rows.end(), 0.0, [this](double res, int row){ return res + RowWeights[row]; });
+        }
+
+        [[nodiscard]] NodeHistogram AcquireHistogram() {
+            auto& spareHistograms = SpareHistograms.local();
+            if (spareHistograms.empty())
+                return {};
+
+            auto histogram = std::move(spareHistograms.back());
+            spareHistograms.pop_back();
+            return histogram;
+        }
+
+        void ReleaseHistogram(NodeHistogram& histogram) {
+            if (!histogram.BinSizes.empty())
+                SpareHistograms.local().push_back(std::move(histogram));
+        }
+    };
+
+    DecisionTreeRegressor::DecisionTreeRegressor(int maxDepth, int minSampleSize, double proportionOfFeaturesUsed, int numOfAvailableThreads,
+        SplittingMode splittingMode, int maxNumOfBins)
         : c_maxDepth(maxDepth)
         , c_minSampleSize(minSampleSize)
         , c_proportionOfFeaturesUsed(proportionOfFeaturesUsed)
+        , c_splittingMode(splittingMode)
+        , c_maxNumOfBins(maxNumOfBins)
         , m_numOfAvailableThreads(numOfAvailableThreads)
+        , m_randomSeed(RandomGenerators::PhiloxRandom::GetNondeterministicSeed())
     {
         if (proportionOfFeaturesUsed <= 0. || proportionOfFeaturesUsed > 1.)
             throw std::invalid_argument("Invalid proportion of features used");
-    }
 
-    DecisionTreeRegressor::DecisionTreeRegressor(int maxDepth, int minSampleSize, double proportionOfFeaturesUsed, int depth, int numOfAvailableThreads)
-        : c_maxDepth(maxDepth)
-        , c_minSampleSize(minSampleSize)
-        , c_proportionOfFeaturesUsed(proportionOfFeaturesUsed)
-        , m_numOfAvailableThreads(numOfAvailableThreads)
-        , m_curDepth(depth)
-    {}
+        if (maxNumOfBins < 2 || maxNumOfBins > QuantizedFeatures::MaxNumOfBins)
+            throw std::invalid_argument("Invalid number of bins");
+    }
 
     void DecisionTreeRegressor::Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset)
     {
-        #pragma omp parallel
-        {
-            #pragma omp single
-            FitImpl(trainingDataset);
+        Fit(trainingDataset, {});
+    }
+
+    void DecisionTreeRegressor::Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset, std::span<const double> sampleWeights)
+    {
+        CheckSampleWeights(trainingDataset.Features, sampleWeights);
+        m_warmStartState.reset();
+
+        std::optional<QuantizedFeatures> quantizedFeatures;
+        if (c_splittingMode == SplittingMode::Histogram)
+            quantizedFeatures.emplace(trainingDataset.Features, c_maxNumOfBins);
+
+        SortedFeatureRows sortedFeatureRows;
+        if (c_splittingMode == SplittingMode::PresortedExact && sampleWeights.empty())
+            sortedFeatureRows = GetSortedFeatureRows(trainingDataset.Features);
+
+        FitFromRoot(trainingDataset, quantizedFeatures ? &*quantizedFeatures : nullptr, sortedFeatureRows, sampleWeights);
+    }
+
+    void DecisionTreeRegressor::Fit(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        const QuantizedFeatures& quantizedFeatures,
+        std::span<const double> sampleWeights)
+    {
+        if (c_splittingMode != SplittingMode::Histogram)
+            throw std::logic_error("Quantized features are used by histogram splitting only");
+
+        const auto& features = trainingDataset.Features;
+        if (quantizedFeatures.GetNumOfFeatures() != features.GetNumOfColumns()
+            || quantizedFeatures.GetNumOfViewableTableRows() != features.GetNumOfViewableTableRows())
+            throw std::invalid_argument("Quantized features don't match the dataset");
+
+        CheckSampleWeights(features, sampleWeights);
+        m_warmStartState.reset();
+        FitFromRoot(trainingDataset, &quantizedFeatures, {}, sampleWeights);
+    }
+
+    void DecisionTreeRegressor::FitIncrementally(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) {
+        const auto& features = trainingDataset.Features;
+        const bool canWarmStart = m_warmStartState
+            && m_warmStartState->FeaturesTable == &features.GetViewableTable()
+            && m_warmStartState->NumOfFeatures == features.GetNumOfColumns()
+            && m_warmStartState->NumOfFittedRows <= features.GetNumOfRows();
+
+        if (!canWarmStart)
+            m_warmStartState.reset(new WarmStartState{&features.GetViewableTable(), features.GetNumOfColumns()});
+
+        auto& state = *m_warmStartState;
+        if (c_splittingMode == SplittingMode::Histogram) {
+            if (!state.Quantized || 2 * state.NumOfQuantizedRows < features.GetNumOfRows()) {
+                state.Quantized.emplace(features, c_maxNumOfBins);
+                state.NumOfQuantizedRows = features.GetNumOfRows();
+            }
+            else {
+                state.Quantized->AddViewableRows(features, state.NumOfFittedRows);
+            }
+        }
+
+        if (c_splittingMode == SplittingMode::PresortedExact) {
+            if (state.NumOfFittedRows == 0)
+                state.SortedRows = GetSortedFeatureRows(features);
+            else
+                MergeSortedFeatureRows(features, state.NumOfFittedRows, state.SortedRows);
         }
+
+        state.NumOfFittedRows = features.GetNumOfRows();
+
+        FitFromRoot(trainingDataset, state.Quantized ? &*state.Quantized : nullptr, state.SortedRows, {});
     }
 
-    void DecisionTreeRegressor::FitImpl(const Datasets::SupervisedLearningDatasetView<double> &trainingDataset) {
+    void DecisionTreeRegressor::FitStreaming(const Datasets::StreamingDatasetSource& source, int chunkSize) {
+        if (chunkSize <= 0)
+            throw std::invalid_argument("Invalid chunk size");
+
+        if (source.GetNumOfRows() <= 0)
+            throw std::invalid_argument("Dataset is empty");
+
+        const int numOfFeatures = source.GetNumOfFeatures();
+        const int numOfOutputs = source.GetNumOfObservations();
+        const auto quantizedFeatures = GetStreamingQuantizedFeatures(source, chunkSize);
+
+        std::vector<StreamingNode> nodes(1);
+        std::vector<int> rowNodeIndexes(source.GetNumOfRows(), 0);
+        std::vector<int> chunkNodeIndexes;
+        Datasets::SupervisedLearningDataset<double> chunk;
+
+        for (int depth = 0, firstLevelNodeIndex = 0; firstLevelNodeIndex < std::ssize(nodes); ++depth) {
+            const int endLevelNodeIndex = std::ssize(nodes);
+            const bool isLevelSplittable = depth < c_maxDepth;
+            for (int nodeIndex = firstLevelNodeIndex; nodeIndex < endLevelNodeIndex; ++nodeIndex) {
+                nodes[nodeIndex].ObservationSums.assign(numOfOutputs, 0.0);
+                if (isLevelSplittable) {
+                    nodes[nodeIndex].BinSizes.assign(numOfFeatures * c_maxNumOfBins, 0);
+                    nodes[nodeIndex].BinSums.assign(numOfFeatures * c_maxNumOfBins * numOfOutputs, 0.0);
+                }
+            }
+
+            for (int firstRowIndex = 0; firstRowIndex < source.GetNumOfRows(); firstRowIndex += chunkSize) {
+                const int numOfRows = std::min(chunkSize, source.GetNumOfRows() - firstRowIndex);
+                source.ReadChunk(firstRowIndex, numOfRows, chunk);
+                const auto& [chunkFeatures, chunkObservations] = std::as_const(chunk);
+
+                chunkNodeIndexes.assign(numOfRows, -1);
+                for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex) {
+                    int& nodeIndex = rowNodeIndexes[firstRowIndex + rowIndex];
+                    if (nodeIndex < firstLevelNodeIndex) {
+                        const auto& parentNode = nodes[nodeIndex];
+                        if (parentNode.LeftChildIndex == -1)
+                            continue;
+
+                        const auto [bestFeatureIndex, bestValue] = parentNode.Splitting;
+                        nodeIndex = parentNode.LeftChildIndex + (chunkFeatures.AtUnchecked(rowIndex, bestFeatureIndex) > bestValue);
+                    }
+
+                    auto& node = nodes[nodeIndex];
+                    chunkNodeIndexes[rowIndex] = nodeIndex;
+                    ++node.NumOfRows;
+                    for (int i = 0; i < numOfOutputs; ++i) {
+                        const double value = chunkObservations.AtUnchecked(rowIndex, i);
+                        node.ObservationSums[i] += value;
+                        node.ObservationSquareSum += value * value;
+                    }
+                }
+
+                if (!isLevelSplittable)
+                    continue;
+
+                #pragma omp parallel for num_threads(m_numOfAvailableThreads) if(m_numOfAvailableThreads > 1 && numOfRows >= MinNumOfRowsPerTask)
+                for (int featureIndex = 0; featureIndex < numOfFeatures; ++featureIndex) {
+                    const auto featuresColumn = chunkFeatures.GetColumnSpan(featureIndex);
+                    for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex) {
+                        if (chunkNodeIndexes[rowIndex] == -1)
+                            continue;
+
+                        auto& node = nodes[chunkNodeIndexes[rowIndex]];
+                        const int binIndex = featureIndex * c_maxNumOfBins + quantizedFeatures.Quantize(featureIndex, featuresColumn[rowIndex]);
+                        ++node.BinSizes[binIndex];
+                        for (int i = 0; i < numOfOutputs; ++i)
+                            node.BinSums[binIndex * numOfOutputs + i] += chunkObservations.AtUnchecked(rowIndex, i);
+                    }
+                }
+            }
+
+            for (int nodeIndex = firstLevelNodeIndex; nodeIndex < endLevelNodeIndex; ++nodeIndex) {
+                if (isLevelSplittable && nodes[nodeIndex].NumOfRows >= c_minSampleSize)
+                    nodes[nodeIndex].Splitting = GetStreamingSplittingParameters(nodes[nodeIndex], nodes[nodeIndex].RandomStream, quantizedFeatures);
+
+                nodes[nodeIndex].BinSizes = {};
+                nodes[nodeIndex].BinSums = {};
+                if (nodes[nodeIndex].Splitting.BestFeatureIndex != -1) {
+                    const auto randomStream = nodes[nodeIndex].RandomStream;
+                    nodes[nodeIndex].LeftChildIndex = std::ssize(nodes);
+                    nodes.resize(nodes.size() + 2);
+                    nodes[nodes.size() - 2].RandomStream = RandomGenerators::PhiloxRandom::GetChildStream(randomStream, 0);
+                    nodes.back().RandomStream = RandomGenerators::PhiloxRandom::GetChildStream(randomStream, 1);
+                }
+            }
+
+            firstLevelNodeIndex = endLevelNodeIndex;
+        }
+
+        m_flatTree = FlatDecisionTree(numOfOutputs);
+        for (const auto& node : nodes) {
+            if (node.LeftChildIndex != -1) {
+                m_flatTree.AddSplitNode(node.Splitting.BestFeatureIndex, node.Splitting.BestValue, node.LeftChildIndex);
+                continue;
+            }
+
+            m_flatTree.AddLeafNode(node.ObservationSums
+                                   | std::views::transform([&node](double sum){ return sum / node.NumOfRows; })
+                                   | RangesUtils::to_vector);
+        }
+    }
+
+    void DecisionTreeRegressor::FitFromRoot(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        const QuantizedFeatures* quantizedFeatures,
+        const SortedFeatureRows& sortedFeatureRows,
+        std::span<const double> sampleWeights)
+    {
+        const auto& features = trainingDataset.Features;
+
+        FitContext context;
+        context.Quantized = quantizedFeatures;
+        if (sampleWeights.empty()) {
+            context.Rows.resize(features.GetNumOfRows());
+            for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex)
+                context.Rows[rowIndex] = features.GetViewableTableRowIndex(rowIndex);
+            context.SortedRows.reserve(sortedFeatureRows.size() * features.GetNumOfRows());
+            for (const auto& rows : sortedFeatureRows)
+                context.SortedRows.insert(context.SortedRows.end(), rows.begin(), rows.end());
+        }
+        else {
+            SetWeightedRows(features, sampleWeights, context);
+        }
+
+        const int numOfRows = std::ssize(context.Rows);
+        BuildNode root;
+        if (m_numOfAvailableThreads <= 1) {
+            GrowNode(root, trainingDataset, 0, 0, 0, numOfRows, {}, context);
+        }
+        else {
+            tbb::task_arena arena(m_numOfAvailableThreads);
+            arena.execute([&]{ GrowNode(root, trainingDataset, 0, 0, 0, numOfRows, {}, context); });
+        }
+
+        BuildFlatTree(root, trainingDataset.Observations.GetNumOfColumns());
+    }
+
+    void DecisionTreeRegressor::GrowNode(
+        BuildNode& node,
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        int depth,
+        std::uint64_t randomStream,
+        int firstRowIndex,
+        int numOfRows,
+        NodeHistogram histogram,
+        FitContext& context) const
+    {
         const auto& [features, observations] = trainingDataset;
+        const auto rows = context.GetNodeRows(firstRowIndex, numOfRows);
+        const std::span<const double> rowWeights = context.RowWeights;
+        const double weightOfRows = context.GetWeightOfRows(rows);
+
+        if (depth >= c_maxDepth || weightOfRows < c_minSampleSize) {
+            context.ReleaseHistogram(histogram);
+            CalculateMeanObservations(observations, rows, rowWeights, weightOfRows, node.LeafValues);
+            return;
+        }
+
+        // Accumulated before the scratch is taken, since this thread may grow other nodes while it waits for the parallel bins
+        const bool isHistogramMode = c_splittingMode == SplittingMode::Histogram;
+        if (isHistogramMode && histogram.BinSizes.empty())
+            histogram = AccumulateNodeHistogram(trainingDataset, rows, context);
 
-        m_meanObservations = GetMeanObservations(observations);
-        m_nodeMse = GetMSE(observations);
+        auto& meanObservations = context.SplitScratches.local().MeanObservations;
+        CalculateMeanObservations(observations, rows, rowWeights, weightOfRows, meanObservations);
+        const double nodeMse = CalculateMSE(observations, rows, rowWeights, weightOfRows, meanObservations);
 
-        if (m_curDepth >= c_maxDepth || features.GetNumOfRows() < c_minSampleSize)
+        node.Splitting = GetSplittingParameters(trainingDataset, firstRowIndex, numOfRows, weightOfRows, nodeMse, randomStream, histogram, context);
+        if (node.Splitting.BestFeatureIndex == -1) {
+            context.ReleaseHistogram(histogram);
+            CalculateMeanObservations(observations, rows, rowWeights, weightOfRows, node.LeafValues);
             return;
+        }
 
-        m_splittingParameters = GetSplittingParameters(trainingDataset);
-        if (m_splittingParameters.BestFeatureIndex == -1)
+        // A midpoint rounded onto the greatest value sends every row to the left, such a node stays a leaf
+        const int numOfLeftRows = PartitionNodeRows(features, firstRowIndex, numOfRows, node.Splitting, context);
+        if (numOfLeftRows == 0 || numOfLeftRows == numOfRows) {
+            node.Splitting = {};
+            context.ReleaseHistogram(histogram);
+            CalculateMeanObservations(observations, rows, rowWeights, weightOfRows, node.LeafValues);
             return;
+        }
 
-        auto [leftNodeDataset, rightNodeDataset] = SplitTrainingDataset(trainingDataset);
+        const int firstRightRowIndex = firstRowIndex + numOfLeftRows;
+        const int numOfRightRows = numOfRows - numOfLeftRows;
+        const auto leftRandomStream = RandomGenerators::PhiloxRandom::GetChildStream(randomStream, 0);
+        const auto rightRandomStream = RandomGenerators::PhiloxRandom::GetChildStream(randomStream, 1);
 
-        const double threadsDistributionCoeff = (double)leftNodeDataset.Features.GetNumOfRows() / (double)rightNodeDataset.Features.GetNumOfRows();
-        const int numOfLeftNodeThreads = std::round(threadsDistributionCoeff * (double)m_numOfAvailableThreads / (1. + threadsDistributionCoeff));
-        const int numOfRightNodeThreads = m_numOfAvailableThreads - numOfLeftNodeThreads;
+        // Only the child of fewer rows reads its rows into bins, the histogram of its sibling is what remains of the parent's.
+        // A sibling of fewer rows than bins reads its own rows faster than it subtracts every bin
+        NodeHistogram leftHistogram;
+        NodeHistogram rightHistogram;
+        if (isHistogramMode && depth + 1 < c_maxDepth && std::max(numOfLeftRows, numOfRightRows) >= c_maxNumOfBins) {
+            const bool isLeftSmaller = numOfLeftRows <= numOfRightRows;
+            auto& smallerHistogram = isLeftSmaller ? leftHistogram : rightHistogram;
+            const auto smallerRows = isLeftSmaller ? context.GetNodeRows(firstRowIndex, numOfLeftRows)
+                                                   : context.GetNodeRows(firstRightRowIndex, numOfRightRows);
+            smallerHistogram = AccumulateNodeHistogram(trainingDataset, smallerRows, context);
+            SubtractNodeHistogram(histogram, smallerHistogram);
+            (isLeftSmaller ? rightHistogram : leftHistogram) = std::move(histogram);
+        }
+        context.ReleaseHistogram(histogram);
 
-        m_leftNode.reset(new DecisionTreeRegressor(c_maxDepth, c_minSampleSize, c_proportionOfFeaturesUsed, m_curDepth + 1, numOfLeftNodeThreads));
-        m_rightNode.reset(new DecisionTreeRegressor(c_maxDepth, c_minSampleSize, c_proportionOfFeaturesUsed, m_curDepth + 1, numOfRightNodeThreads));
+        auto& nodeArena = context.NodeArenas.local();
+        node.LeftChild = &nodeArena.emplace_back();
+        node.RightChild = &nodeArena.emplace_back();
 
-        if (m_numOfAvailableThreads <= 1)
+        if (m_numOfAvailableThreads <= 1 || numOfRows < MinNumOfRowsPerTask)
         {
-            m_leftNode->FitImpl(leftNodeDataset);
-            m_rightNode->FitImpl(rightNodeDataset);
+            GrowNode(*node.LeftChild, trainingDataset, depth + 1, leftRandomStream, firstRowIndex, numOfLeftRows, std::move(leftHistogram), context);
+            GrowNode(*node.RightChild, trainingDataset, depth + 1, rightRandomStream, firstRightRowIndex, numOfRightRows, std::move(rightHistogram), context);
             return;
         }
 
-        #pragma omp task
-        m_leftNode->FitImpl(leftNodeDataset);
-
-        #pragma omp task
-        m_rightNode->FitImpl(rightNodeDataset);
+        // Idle threads of the arena steal the left subtree, the right one is grown by this thread meanwhile
+        tbb::task_group leftNodeTask;
+        leftNodeTask.run([&]{ GrowNode(*node.LeftChild, trainingDataset, depth + 1, leftRandomStream, firstRowIndex, numOfLeftRows, std::move(leftHistogram), context); });
+        GrowNode(*node.RightChild, trainingDataset, depth + 1, rightRandomStream, firstRightRowIndex, numOfRightRows, std::move(rightHistogram), context);
+        leftNodeTask.wait();
     }
 
     std::vector<double> DecisionTreeRegressor::Predict(const std::vector<double>& features) const {
-        return PredictImpl(features);
+        const auto leafValues = m_flatTree.Predict(features);
+        return {leafValues.begin(), leafValues.end()};
     }
 
     DataContainers::Table<double> DecisionTreeRegressor::Predict(const DataContainers::TableView<double>& features) const {
-        DataContainers::Table<double> res;
-        res.SetNumOfColumns(std::ssize(m_meanObservations));
+        const int numOfPredictedValues = m_flatTree.GetNumOfPredictedValues();
 
-        for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex)
-            res.PushBackRow(PredictImpl(features.GetRow(rowIndex)));
+        return BatchPredictionUtils::PredictByRowBlocks(features, numOfPredictedValues,
+            [this, numOfPredictedValues](const BatchPredictionUtils::FeaturesBlock& featuresBlock, std::span<double> predictions) {
+                std::array<int, BatchPredictionUtils::RowBlockSize> leafNodeIndexes{};
+                m_flatTree.FindLeafNodes(featuresBlock.Values, featuresBlock.NumOfRows, leafNodeIndexes);
 
-        return res;
+                for (int rowIndex = 0; rowIndex < featuresBlock.NumOfRows; ++rowIndex)
+                    std::ranges::copy(m_flatTree.GetLeafValues(leafNodeIndexes[rowIndex]), predictions.begin() + rowIndex * numOfPredictedValues);
+            });
+    }
+
+    std::unique_ptr<RegressionModel> DecisionTreeRegressor::CreateUnfittedCopy() const {
+        auto copy = std::make_unique<DecisionTreeRegressor>(c_maxDepth, c_minSampleSize, c_proportionOfFeaturesUsed, m_numOfAvailableThreads,
+                                                            c_splittingMode, c_maxNumOfBins);
+        copy->SetRandomSeed(m_randomSeed);
+        return copy;
+    }
+
+    void DecisionTreeRegressor::SaveToFile(const std::string& fileName) const {
+        if (m_flatTree.GetNumOfNodes() == 0)
+            throw std::logic_error("Model is not fitted");
+
+        const std::array trees{&m_flatTree};
+        ModelSerializationUtils::SaveModelToFile(fileName, ModelSerializationUtils::ModelType::DecisionTree, m_flatTree.GetNumOfPredictedValues(),
+                                                 GetSerializedParameters(), trees);
+    }
+
+    DecisionTreeRegressor DecisionTreeRegressor::LoadFromFile(const std::string& fileName) {
+        auto modelFile = ModelSerializationUtils::LoadModelFromFile(fileName, ModelSerializationUtils::ModelType::DecisionTree);
+        if (modelFile.Trees.size() != 1)
+            throw std::invalid_argument("Decision tree model file must contain one tree");
+
+        auto tree = CreateFromSerializedParameters(modelFile.Parameters);
+        tree.m_flatTree = std::move(modelFile.Trees.front());
+        return tree;
+    }
+
+    std::vector<double> DecisionTreeRegressor::GetSerializedParameters() const {
+        return {static_cast<double>(c_maxDepth), static_cast<double>(c_minSampleSize), c_proportionOfFeaturesUsed,
+                static_cast<double>(m_numOfAvailableThreads), static_cast<double>(c_splittingMode), static_cast<double>(c_maxNumOfBins)};
     }
 
-    std::vector<double> DecisionTreeRegressor::GetMeanObservations(const DataContainers::TableView<double>& observations) {
-        std::vector<double> meanObservations(observations.GetNumOfColumns());
-        const double numOfRows = observations.GetNumOfRows();
+    DecisionTreeRegressor DecisionTreeRegressor::CreateFromSerializedParameters(std::span<const double> parameters) {
+        if (parameters.size() != 6)
+            throw std::invalid_argument("Invalid number of decision tree parameters");
+
+        return DecisionTreeRegressor(static_cast<int>(parameters[0]), static_cast<int>(parameters[1]), parameters[2],
+                                     static_cast<int>(parameters[3]), static_cast<SplittingMode>(parameters[4]), static_cast<int>(parameters[5]));
+    }
+
+    void DecisionTreeRegressor::CalculateMeanObservations(
+        const DataContainers::TableView<double>& observations,
+        std::span<const int> rows,
+        std::span<const double> rowWeights,
+        double weightOfRows,
+        std::vector<double>& meanObservations)
+    {
+        meanObservations.assign(observations.GetNumOfColumns(), 0.0);
         for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex) {
-            const auto column = observations.GetColumn(columnIndex);
-            meanObservations[columnIndex] = std::accumulate(column.begin(), column.end(), 0.0,
-                                                        [numOfRows](double res, double val){ return res + val / numOfRows;});
+            const auto column = observations.GetViewableTableColumnSpan(columnIndex);
+            for (auto row : rows)
+                meanObservations[columnIndex] += GetRowWeight(rowWeights, row) * column[row] / weightOfRows;
         }
-
-        return meanObservations;
     }
 
-    double DecisionTreeRegressor::GetMSE(const DataContainers::TableView<double> &observations) const {
+    double DecisionTreeRegressor::CalculateMSE(
+        const DataContainers::TableView<double> &observations,
+        std::span<const int> rows,
+        std::span<const double> rowWeights,
+        double weightOfRows,
+        const std::vector<double>& meanObservations)
+    {
         double mse = 0.0;
-        const auto n = static_cast<double>(observations.GetNumOfRows() * std::ssize(m_meanObservations));
+        const auto n = weightOfRows * static_cast<double>(std::ssize(meanObservations));
 
         for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex)
         {
-            auto column = observations.GetColumn(columnIndex);
-            mse += std::transform_reduce(column.begin(), column.end(), 0.0,
-                                         std::plus(),
-                                         [n, prediction = m_meanObservations[columnIndex]](double observation)
-                                            { return (observation - prediction) / n * (observation - prediction); });
+            const auto column = observations.GetViewableTableColumnSpan(columnIndex);
+            const double prediction = meanObservations[columnIndex];
+            double columnMse = 0.0;
+            for (auto row : rows) {
+                const double observation = column[row];
+                columnMse += GetRowWeight(rowWeights, row) * (observation - prediction) / n * (observation - prediction);
+            }
+            mse += columnMse;
         }
 
         return mse;
     }
 
+    DecisionTreeRegressor::NodeStatistics DecisionTreeRegressor::GetNodeStatistics(
+        const DataContainers::TableView<double>& observations,
+        std::span<const int> rows,
+        std::span<const double> rowWeights,
+        double weightOfRows)
+    {
+        const auto n = static_cast<double>(observations.GetNumOfColumns()) * weightOfRows;
+        NodeStatistics res{std::sqrt(n), 0.0, std::vector<double>(observations.GetNumOfColumns(), 0.0), weightOfRows};
+        for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex) {
+            const auto column = observations.GetViewableTableColumnSpan(columnIndex);
+            for (auto row : rows) {
+                const double value = column[row];
+                const double weight = GetRowWeight(rowWeights, row);
+                res.ObservationMeanSquareSum += weight * value / n * value;
+                res.ObservationsMeanSums[columnIndex] += weight * value / res.SqrtOfN;
+            }
+        }
+
+        return res;
+    }
+
+    double DecisionTreeRegressor::GetSplitMse(
+        const NodeStatistics& nodeStatistics,
+        const std::vector<double>& leftMeanSums, double leftWeight,
+        const std::vector<double>& rightMeanSums, double rightWeight)
+    {
+        const double leftMeanSumSquared = std::accumulate(leftMeanSums.begin(), leftMeanSums.end(), 0.0,
+                                                          [leftWeight](double res, double val){ return res + val / leftWeight * val; });
+        const double rightMeanSumSquared = std::accumulate(rightMeanSums.begin(), rightMeanSums.end(), 0.0,
+                                                           [rightWeight](double res, double val){ return res + val / rightWeight * val; });
+        return nodeStatistics.ObservationMeanSquareSum - leftMeanSumSquared - rightMeanSumSquared;
+    }
+
     DecisionTreeRegressor::SplittingParameters
-    DecisionTreeRegressor::GetSplittingParameters(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) const {
+    DecisionTreeRegressor::GetSplittingParameters(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        int firstRowIndex,
+        int numOfRows,
+        double weightOfRows,
+        double nodeMse,
+        std::uint64_t randomStream,
+        const NodeHistogram& histogram,
+        FitContext& context) const
+    {
+        const auto rows = context.GetNodeRows(firstRowIndex, numOfRows);
+        const std::span<const double> rowWeights = context.RowWeights;
+        const auto nodeStatistics = GetNodeStatistics(trainingDataset.Observations, rows, rowWeights, weightOfRows);
+        const auto featureSubset = GetRandomSubsetOfFeatures(trainingDataset.Features.GetNumOfColumns(), randomStream);
+        const bool isParallel = m_numOfAvailableThreads > 1;
+
+        std::vector<BestSplit> featureBestSplits(featureSubset.size(), BestSplit{{}, nodeMse});
+        const auto updateFeatureBestSplit = [&](int subsetIndex) {
+            const int featureIndex = featureSubset[subsetIndex];
+            auto& scratch = context.SplitScratches.local();
+            switch (c_splittingMode) {
+                case SplittingMode::Exact:
+                    UpdateBestExactSplit(trainingDataset, rows, rowWeights, featureIndex, nodeStatistics, scratch, featureBestSplits[subsetIndex]);
+                    break;
+                case SplittingMode::PresortedExact:
+                    UpdateBestPresortedSplit(trainingDataset, context.GetNodeSortedRows(featureIndex, firstRowIndex, numOfRows), rowWeights, featureIndex, nodeStatistics, scratch, featureBestSplits[subsetIndex]);
+                    break;
+                case SplittingMode::Histogram:
+                    UpdateBestHistogramSplit(histogram, *context.Quantized, featureIndex, nodeStatistics, scratch, featureBestSplits[subsetIndex]);
+                    break;
+            }
+        };
+
+        if (isParallel && numOfRows >= MinNumOfRowsPerTask)
+            tbb::parallel_for(0, static_cast<int>(featureSubset.size()), updateFeatureBestSplit);
+        else
+            for (int subsetIndex = 0; subsetIndex < std::ssize(featureSubset); ++subsetIndex)
+                updateFeatureBestSplit(subsetIndex);
+
+        // Reduced in subset order, so equal splits resolve to the same feature whatever the number of threads
+        BestSplit bestSplit{{}, nodeMse};
+        for (const auto& featureBestSplit : featureBestSplits)
+            if (featureBestSplit.Mse < bestSplit.Mse)
+                bestSplit = featureBestSplit;
+
+        return bestSplit.Parameters;
+    }
+
+    void DecisionTreeRegressor::UpdateBestExactSplit(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        std::span<const int> rows,
+        std::span<const double> rowWeights,
+        int featureIndex,
+        const NodeStatistics& nodeStatistics,
+        SplitScratch& scratch,
+        BestSplit& bestSplit)
+    {
         const auto& [features, observations] = trainingDataset;
+        auto& observationsTableColumns = scratch.ObservationsColumns;
+        observationsTableColumns.resize(observations.GetNumOfColumns());
+        for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex)
+            observationsTableColumns[columnIndex] = observations.GetViewableTableColumnSpan(columnIndex);
 
-        const auto n = static_cast<double>(observations.GetNumOfColumns() * observations.GetNumOfRows());
-        const double sqrtOfN = std::sqrt(n);
-        double observationMeanSquareSum = 0.0;
-        std::vector<double> observationsMeanSums(observations.GetNumOfColumns(), 0.0);
-        for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex) {
-            for (auto value : observations.GetColumn(columnIndex)) {
-                observationMeanSquareSum += value / n * value;
-                observationsMeanSums[columnIndex] += value / sqrtOfN;
+        auto& leftMeanSums = scratch.LeftMeanSums;
+        auto& rightMeanSums = scratch.RightMeanSums;
+        leftMeanSums.assign(nodeStatistics.ObservationsMeanSums.size(), 0.0);
+        rightMeanSums.assign(nodeStatistics.ObservationsMeanSums.begin(), nodeStatistics.ObservationsMeanSums.end());
+        int numOfLeftObservations = 0;
+        double leftWeight = 0.0;
+        double rightWeight = nodeStatistics.Weight;
+
+        const auto featuresTableColumn = features.GetViewableTableColumnSpan(featureIndex);
+        auto& featuresColumn = scratch.FeaturesColumn;
+        featuresColumn.resize(rows.size());
+        std::ranges::transform(rows, featuresColumn.begin(), [featuresTableColumn](int row){ return featuresTableColumn[row]; });
+        auto& rowIndexes = scratch.RowIndexes;
+        rowIndexes.resize(featuresColumn.size());
+        std::iota(rowIndexes.begin(), rowIndexes.end(), 0);
+        std::ranges::sort(rowIndexes,[&featuresColumn](int a, int b){ return featuresColumn[a] < featuresColumn[b]; });
+        auto sortedFeaturesColumn = rowIndexes | std::views::transform(
+                [&featuresColumn](int i){ return featuresColumn[i]; });
+
+        CalculateMovingAverage(featuresColumn, rowIndexes, scratch);
+        for (auto value : scratch.MovingAverage) {
+            for(;numOfLeftObservations < std::ssize(featuresColumn) - 1 && sortedFeaturesColumn[numOfLeftObservations] < value; ++numOfLeftObservations) {
+                const int row = rows[rowIndexes[numOfLeftObservations]];
+                const double weight = GetRowWeight(rowWeights, row);
+                leftWeight += weight;
+                rightWeight -= weight;
+                for (int i = 0; i < std::ssize(leftMeanSums); ++i) {
+                    const double val = weight * observationsTableColumns[i][row];
+                    leftMeanSums[i] += val / nodeStatistics.SqrtOfN;
+                    rightMeanSums[i] -= val / nodeStatistics.SqrtOfN;
+                }
             }
+            const double newMse = GetSplitMse(nodeStatistics, leftMeanSums, leftWeight, rightMeanSums, rightWeight);
+            if (newMse < bestSplit.Mse)
+                bestSplit = {{featureIndex, value}, newMse};
         }
-        double bestMse = m_nodeMse;
-        SplittingParameters res;
+    }
 
-        for (auto featureIndex : GetRandomSubsetOfFeatures(features.GetNumOfColumns())) {
-            std::vector<double> leftMeanSums(observationsMeanSums.size(), 0.0);
-            std::vector<double> rightMeanSums(observationsMeanSums);
-            int numOfLeftObservations = 0;
-            int numOfRightObservations = observations.GetNumOfRows();
+    void DecisionTreeRegressor::UpdateBestPresortedSplit(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        std::span<const int> sortedRows,
+        std::span<const double> rowWeights,
+        int featureIndex,
+        const NodeStatistics& nodeStatistics,
+        SplitScratch& scratch,
+        BestSplit& bestSplit)
+    {
+        const auto& [features, observations] = trainingDataset;
+        auto& observationsTableColumns = scratch.ObservationsColumns;
+        observationsTableColumns.resize(observations.GetNumOfColumns());
+        for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex)
+            observationsTableColumns[columnIndex] = observations.GetViewableTableColumnSpan(columnIndex);
+        const auto featuresTableColumn = features.GetViewableTableColumnSpan(featureIndex);
+        const auto sortedFeaturesColumn = sortedRows | std::views::transform(
+                [featuresTableColumn](int i){ return featuresTableColumn[i]; });
 
-            const auto featuresColumn = features.GetColumn(featureIndex) | RangesUtils::to_vector;
-            std::vector<int> rowIndexes(featuresColumn.size());
-            std::iota(rowIndexes.begin(), rowIndexes.end(), 0);
-            std::ranges::sort(rowIndexes,[&featuresColumn](int a, int b){ return featuresColumn[a] < featuresColumn[b]; });
-            auto sortedFeaturesColumn = rowIndexes | std::views::transform(
-                    [&featuresColumn](int i){ return featuresColumn[i]; });
-
-            for (auto value : GetMovingAverage(featuresColumn, rowIndexes)) {
-                for(;numOfLeftObservations < std::ssize(featuresColumn) - 1 && sortedFeaturesColumn[numOfLeftObservations] < value; ++numOfLeftObservations, --numOfRightObservations) {
-                    const auto row = observations.GetRow(rowIndexes[numOfLeftObservations]);
-                    for (int i = 0; i < row.GetSize(); ++i) {
-                        const double val = row.At(i);
-                        leftMeanSums[i] += val / sqrtOfN;
-                        rightMeanSums[i] -= val / sqrtOfN;
-                    }
-                }
-                const double leftMeanSumSquared = std::accumulate(leftMeanSums.begin(), leftMeanSums.end(), 0.0,
-                                                              [numOfLeftObservations](double res, double val){ return res + val / numOfLeftObservations * val; });
-                const double rightMeanSumSquared = std::accumulate(rightMeanSums.begin(), rightMeanSums.end(), 0.0,
-                                                               [numOfRightObservations](double res, double val){ return res + val / numOfRightObservations * val; });
-                const double newMse = observationMeanSquareSum - leftMeanSumSquared - rightMeanSumSquared;
-                if (newMse < bestMse) {
-                    res = {featureIndex, value};
-                    bestMse = newMse;
+        auto& leftMeanSums = scratch.LeftMeanSums;
+        auto& rightMeanSums = scratch.RightMeanSums;
+        leftMeanSums.assign(nodeStatistics.ObservationsMeanSums.size(), 0.0);
+        rightMeanSums.assign(nodeStatistics.ObservationsMeanSums.begin(), nodeStatistics.ObservationsMeanSums.end());
+        int numOfLeftObservations = 0;
+        double leftWeight = 0.0;
+        double rightWeight = nodeStatistics.Weight;
+
+        for (int i = 1; i < std::ssize(sortedRows); ++i) {
+            if (sortedFeaturesColumn[i - 1] == sortedFeaturesColumn[i])
+                continue;
+
+            const double value = sortedFeaturesColumn[i - 1] / WindowSize + sortedFeaturesColumn[i] / WindowSize;
+            for(;numOfLeftObservations < std::ssize(sortedRows) - 1 && sortedFeaturesColumn[numOfLeftObservations] < value; ++numOfLeftObservations) {
+                const int row = sortedRows[numOfLeftObservations];
+                const double weight = GetRowWeight(rowWeights, row);
+                leftWeight += weight;
+                rightWeight -= weight;
+                for (int j = 0; j < std::ssize(leftMeanSums); ++j) {
+                    const double val = weight * observationsTableColumns[j][row];
+                    leftMeanSums[j] += val / nodeStatistics.SqrtOfN;
+                    rightMeanSums[j] -= val / nodeStatistics.SqrtOfN;
                 }
             }
+            const double newMse = GetSplitMse(nodeStatistics, leftMeanSums, leftWeight, rightMeanSums, rightWeight);
+            if (newMse < bestSplit.Mse)
+                bestSplit = {{featureIndex, value}, newMse};
         }
+    }
 
-        return res;
+    void DecisionTreeRegressor::UpdateBestHistogramSplit(
+        const NodeHistogram& histogram,
+        const QuantizedFeatures& quantizedFeatures,
+        int featureIndex,
+        const NodeStatistics& nodeStatistics,
+        SplitScratch& scratch,
+        BestSplit& bestSplit) const
+    {
+        const int numOfBins = quantizedFeatures.GetNumOfBins(featureIndex);
+        const int numOfOutputs = std::ssize(nodeStatistics.ObservationsMeanSums);
+        const int firstBinIndex = featureIndex * c_maxNumOfBins;
+        const auto binSizes = std::span(histogram.BinSizes).subspan(firstBinIndex, numOfBins);
+        const auto binSums = std::span(histogram.BinSums).subspan(firstBinIndex * numOfOutputs, numOfBins * numOfOutputs);
+
+        // Empty bins are skipped by the search, so only the filled ones are scaled
+        auto& binMeanSums = scratch.BinMeanSums;
+        binMeanSums.resize(binSums.size());
+        for (int binIndex = 0; binIndex < numOfBins; ++binIndex)
+            if (binSizes[binIndex] != 0)
+                for (int i = binIndex * numOfOutputs; i < (binIndex + 1) * numOfOutputs; ++i)
+                    binMeanSums[i] = binSums[i] / nodeStatistics.SqrtOfN;
+
+        UpdateBestSplitOverBins(quantizedFeatures, featureIndex, binSizes, std::span(histogram.BinWeights).subspan(firstBinIndex, numOfBins),
+                                binMeanSums, nodeStatistics, scratch, bestSplit);
     }
 
-    DecisionTreeRegressor::ChildNodesTrainingDataset
-    DecisionTreeRegressor::SplitTrainingDataset(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) const {
-        const auto& [features, observations] = trainingDataset;
+    DecisionTreeRegressor::NodeHistogram DecisionTreeRegressor::AccumulateNodeHistogram(
+        const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+        std::span<const int> rows,
+        FitContext& context) const
+    {
+        const auto& observations = trainingDataset.Observations;
+        const auto& quantizedFeatures = *context.Quantized;
+        const std::span<const double> rowWeights = context.RowWeights;
+        const int numOfFeatures = quantizedFeatures.GetNumOfFeatures();
+        const int numOfOutputs = observations.GetNumOfColumns();
+        const int numOfRows = std::ssize(rows);
+        const int blockSize = std::max(HistogramRowBlockSize, (numOfRows + MaxNumOfHistogramBlocks - 1) / MaxNumOfHistogramBlocks);
+        const int numOfBlocks = std::max(1, (numOfRows + blockSize - 1) / blockSize);
+        const int numOfHistogramBins = numOfFeatures * c_maxNumOfBins;
+        std::vector<std::span<const double>> observationsTableColumns(numOfOutputs);
+        for (int columnIndex = 0; columnIndex < numOfOutputs; ++columnIndex)
+            observationsTableColumns[columnIndex] = observations.GetViewableTableColumnSpan(columnIndex);
+
+        const auto acquireEmptyHistogram = [&]() {
+            auto histogram = context.AcquireHistogram();
+            histogram.BinSizes.assign(numOfHistogramBins, 0);
+            histogram.BinWeights.assign(numOfHistogramBins, 0.0);
+            histogram.BinSums.assign(numOfHistogramBins * numOfOutputs, 0.0);
+            return histogram;
+        };
 
-        Datasets::SupervisedLearningDatasetView<double> leftNodeData(features.GetViewableTable(),observations.GetViewableTable());
-        auto rightNodeData = leftNodeData;
-        const auto [bestFeatureIndex, bestValue] = m_splittingParameters;
+        const auto accumulateBlock = [&](NodeHistogram& blockHistogram, int blockIndex, int featureIndex) {
+            const int firstBinIndex = featureIndex * c_maxNumOfBins;
+            int* blockBinSizes = blockHistogram.BinSizes.data() + firstBinIndex;
+            double* blockBinWeights = blockHistogram.BinWeights.data() + firstBinIndex;
+            double* blockBinSums = blockHistogram.BinSums.data() + firstBinIndex * numOfOutputs;
+            const int endRowIndex = std::min(numOfRows, (blockIndex + 1) * blockSize);
 
-        auto addRowToTables = [f = &features, o = &observations](auto& nodeData, int rowIndex){
-            nodeData.Features.PushBackViewableRowIndex(f->GetViewableTableRowIndex(rowIndex));
-            nodeData.Observations.PushBackViewableRowIndex(o->GetViewableTableRowIndex(rowIndex));
+            for (int rowIndex = blockIndex * blockSize; rowIndex < endRowIndex; ++rowIndex) {
+                const int row = rows[rowIndex];
+                const int binIndex = quantizedFeatures.GetBinIndex(row, featureIndex);
+                const double weight = GetRowWeight(rowWeights, row);
+                ++blockBinSizes[binIndex];
+                blockBinWeights[binIndex] += weight;
+
+                for (int i = 0; i < numOfOutputs; ++i)
+                    blockBinSums[binIndex * numOfOutputs + i] += weight * observationsTableColumns[i][row];
+            }
         };
-        for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex)
-            addRowToTables(features.At(rowIndex, bestFeatureIndex) > bestValue ? rightNodeData : leftNodeData, rowIndex);
 
-        return {leftNodeData, rightNodeData};
+        // The first block is accumulated straight into the node histogram and every other block into bins of its own that are added in order,
+        // so bins don't depend on the number of threads
+        auto histogram = acquireEmptyHistogram();
+        if (m_numOfAvailableThreads <= 1 || numOfRows < MinNumOfRowsPerTask) {
+            for (int featureIndex = 0; featureIndex < numOfFeatures; ++featureIndex)
+                accumulateBlock(histogram, 0, featureIndex);
+
+            // The bins of a released block are acquired again by the next one
+            for (int blockIndex = 1; blockIndex < numOfBlocks; ++blockIndex) {
+                auto blockHistogram = acquireEmptyHistogram();
+                for (int featureIndex = 0; featureIndex < numOfFeatures; ++featureIndex)
+                    accumulateBlock(blockHistogram, blockIndex, featureIndex);
+                AddNodeHistogram(histogram, blockHistogram);
+                context.ReleaseHistogram(blockHistogram);
+            }
+
+            return histogram;
+        }
+
+        std::vector<NodeHistogram> blockHistograms;
+        for (int blockIndex = 1; blockIndex < numOfBlocks; ++blockIndex)
+            blockHistograms.push_back(acquireEmptyHistogram());
+
+        tbb::parallel_for(0, numOfBlocks * numOfFeatures, [&](int taskIndex) {
+            const int blockIndex = taskIndex / numOfFeatures;
+            accumulateBlock(blockIndex == 0 ? histogram : blockHistograms[blockIndex - 1], blockIndex, taskIndex % numOfFeatures);
+        });
+
+        for (auto& blockHistogram : blockHistograms) {
+            AddNodeHistogram(histogram, blockHistogram);
+            context.ReleaseHistogram(blockHistogram);
+        }
+
+        return histogram;
     }
 
-    const std::vector<double>& DecisionTreeRegressor::PredictImpl(const std::ranges::random_access_range auto& featureRange) const {
-        auto featureIterator = std::ranges::begin(featureRange);
-        const auto* curNode = this;
+    void DecisionTreeRegressor::AddNodeHistogram(NodeHistogram& histogram, const NodeHistogram& addend) {
+        std::ranges::transform(histogram.BinSizes, addend.BinSizes, histogram.BinSizes.begin(), std::plus());
+        std::ranges::transform(histogram.BinWeights, addend.BinWeights, histogram.BinWeights.begin(), std::plus());
+        std::ranges::transform(histogram.BinSums, addend.BinSums, histogram.BinSums.begin(), std::plus());
+    }
+
+    void DecisionTreeRegressor::SubtractNodeHistogram(NodeHistogram& histogram, const NodeHistogram& subtrahend) {
+        std::ranges::transform(histogram.BinSizes, subtrahend.BinSizes, histogram.BinSizes.begin(), std::minus());
+        std::ranges::transform(histogram.BinWeights, subtrahend.BinWeights, histogram.BinWeights.begin(), std::minus());
+        std::ranges::transform(histogram.BinSums, subtrahend.BinSums, histogram.BinSums.begin(), std::minus());
+    }
 
-        while (true) {
-            auto [bestFeatureIndex, bestValue] = curNode->m_splittingParameters;
-            if (bestFeatureIndex == -1)
-                return curNode->m_meanObservations;
+    void DecisionTreeRegressor::UpdateBestSplitOverBins(
+        const QuantizedFeatures& quantizedFeatures,
+        int featureIndex,
+        std::span<const int> binSizes,
+        std::span<const double> binWeights,
+        std::span<const double> binMeanSums,
+        const NodeStatistics& nodeStatistics,
+        SplitScratch& scratch,
+        BestSplit& bestSplit)
+    {
+        const int numOfBins = std::ssize(binSizes);
+        const int numOfOutputs = std::ssize(nodeStatistics.ObservationsMeanSums);
 
-            curNode = featureIterator[bestFeatureIndex] > bestValue ? curNode->m_rightNode.get() : curNode->m_leftNode.get();
+        auto& leftMeanSums = scratch.LeftMeanSums;
+        auto& rightMeanSums = scratch.RightMeanSums;
+        leftMeanSums.assign(numOfOutputs, 0.0);
+        rightMeanSums.assign(nodeStatistics.ObservationsMeanSums.begin(), nodeStatistics.ObservationsMeanSums.end());
+        int numOfRightObservations = std::reduce(binSizes.begin(), binSizes.end());
+        double leftWeight = 0.0;
+        double rightWeight = std::reduce(binWeights.begin(), binWeights.end());
+
+        for (int binIndex = 0; binIndex < numOfBins - 1; ++binIndex) {
+            if (binSizes[binIndex] == 0)
+                continue;
+
+            numOfRightObservations -= binSizes[binIndex];
+            if (numOfRightObservations == 0)
+                break;
+
+            leftWeight += binWeights[binIndex];
+            rightWeight -= binWeights[binIndex];
+
+            for (int i = 0; i < numOfOutputs; ++i) {
+                leftMeanSums[i] += binMeanSums[binIndex * numOfOutputs + i];
+                rightMeanSums[i] -= binMeanSums[binIndex * numOfOutputs + i];
+            }
+
+            const double newMse = GetSplitMse(nodeStatistics, leftMeanSums, leftWeight, rightMeanSums, rightWeight);
+            if (newMse < bestSplit.Mse)
+                bestSplit = {{featureIndex, quantizedFeatures.GetBinUpperBound(featureIndex, binIndex)}, newMse};
         }
     }
 
-    std::vector<double> DecisionTreeRegressor::GetMovingAverage(const std::vector<double>& column, std::vector<int> sortedColumnElemIndexes) {
-        const auto rubbish = std::ranges::unique(sortedColumnElemIndexes, [&column](int a, int b){ return column[a] == column[b]; });
-        const auto numOfUniqueElements = std::ranges::distance(std::ranges::begin(sortedColumnElemIndexes), std::ranges::begin(rubbish));
-        const auto uniqueColumnElem =   sortedColumnElemIndexes
-                                        | std::views::take(numOfUniqueElements)
-                                        | std::views::transform([&column](int i){ return column[i]; });
+    QuantizedFeatures DecisionTreeRegressor::GetStreamingQuantizedFeatures(const Datasets::StreamingDatasetSource& source, int chunkSize) const {
+        const int samplingStep = (source.GetNumOfRows() + MaxNumOfQuantizationSamples - 1) / MaxNumOfQuantizationSamples;
+
+        DataContainers::Table<double> samples(0, source.GetNumOfFeatures());
+        samples.ReserveRows(source.GetNumOfRows() / samplingStep + 1);
 
-        std::vector<double> res(numOfUniqueElements - WindowSize + 1);
+        Datasets::SupervisedLearningDataset<double> chunk;
+        std::vector<double> sample(source.GetNumOfFeatures());
+        for (int firstRowIndex = 0; firstRowIndex < source.GetNumOfRows(); firstRowIndex += chunkSize) {
+            const int numOfRows = std::min(chunkSize, source.GetNumOfRows() - firstRowIndex);
+            source.ReadChunk(firstRowIndex, numOfRows, chunk);
+
+            for (int rowIndex = (samplingStep - firstRowIndex % samplingStep) % samplingStep; rowIndex < numOfRows; rowIndex += samplingStep) {
+                std::as_const(chunk.Features).GetRow(rowIndex, sample.begin());
+                samples.PushBackRow(sample);
+            }
+        }
+
+        return {samples, c_maxNumOfBins};
+    }
+
+    DecisionTreeRegressor::SplittingParameters
+    DecisionTreeRegressor::GetStreamingSplittingParameters(const StreamingNode& node, std::uint64_t randomStream, const QuantizedFeatures& quantizedFeatures) const {
+        const int numOfOutputs = std::ssize(node.ObservationSums);
+        const auto n = static_cast<double>(node.NumOfRows * numOfOutputs);
+        NodeStatistics nodeStatistics{std::sqrt(n), node.ObservationSquareSum / n, {}, static_cast<double>(node.NumOfRows)};
+        for (auto sum : node.ObservationSums)
+            nodeStatistics.ObservationsMeanSums.push_back(sum / nodeStatistics.SqrtOfN);
+
+        const double nodeMse = std::accumulate(nodeStatistics.ObservationsMeanSums.begin(), nodeStatistics.ObservationsMeanSums.end(), nodeStatistics.ObservationMeanSquareSum,
+                                               [&node](double res, double val){ return res - val / node.NumOfRows * val; });
+        BestSplit bestSplit{{}, nodeMse};
+
+        SplitScratch scratch;
+        auto& binWeights = scratch.BinWeights;
+        auto& binMeanSums = scratch.BinMeanSums;
+        for (auto featureIndex : GetRandomSubsetOfFeatures(quantizedFeatures.GetNumOfFeatures(), randomStream)) {
+            const int numOfBins = quantizedFeatures.GetNumOfBins(featureIndex);
+            const auto binSizes = std::span(node.BinSizes).subspan(featureIndex * c_maxNumOfBins, numOfBins);
+            const auto binSums = std::span(node.BinSums).subspan(featureIndex * c_maxNumOfBins * numOfOutputs, numOfBins * numOfOutputs);
+
+            binWeights.assign(binSizes.begin(), binSizes.end());
+            binMeanSums.resize(binSums.size());
+            std::ranges::transform(binSums, binMeanSums.begin(), [&nodeStatistics](double sum){ return sum / nodeStatistics.SqrtOfN; });
+            UpdateBestSplitOverBins(quantizedFeatures, featureIndex, binSizes, binWeights, binMeanSums, nodeStatistics, scratch, bestSplit);
+        }
+
+        return bestSplit.Parameters;
+    }
+
+    void DecisionTreeRegressor::CheckSampleWeights(const DataContainers::TableView<double>& features, std::span<const double> sampleWeights) {
+        if (!sampleWeights.empty() && std::ssize(sampleWeights) != features.GetNumOfRows())
+            throw std::invalid_argument("Number of sample weights and rows don't coincide");
+
+        if (std::ranges::any_of(sampleWeights, [](double weight){ return !(weight >= 0.0); }))
+            throw std::invalid_argument("Sample weight is negative");
+
+        if (std::ranges::any_of(sampleWeights, [](double weight){ return weight != std::trunc(weight); }))
+            throw std::invalid_argument("Sample weight is not a whole number");
+
+        if (!sampleWeights.empty() && std::ranges::none_of(sampleWeights, [](double weight){ return weight > 0.0; }))
+            throw std::invalid_argument("Sample weights are all zero");
+    }
+
+    void DecisionTreeRegressor::SetWeightedRows(
+        const DataContainers::TableView<double>& features,
+        std::span<const double> sampleWeights,
+        FitContext& context) const
+    {
+        // Repeated rows of the view become one row of their total weight, rows of zero weight are left out
+        context.RowWeights.assign(features.GetViewableTable().GetNumOfRows(), 0.0);
+        for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex) {
+            const int row = features.GetViewableTableRowIndex(rowIndex);
+            if (sampleWeights[rowIndex] > 0.0 && context.RowWeights[row] == 0.0)
+                context.Rows.push_back(row);
+            context.RowWeights[row] += sampleWeights[rowIndex];
+        }
+
+        if (c_splittingMode != SplittingMode::PresortedExact)
+            return;
+
+        const int numOfRows = std::ssize(context.Rows);
+        context.SortedRows.resize(features.GetNumOfColumns() * context.Rows.size());
+
+        #pragma omp parallel for num_threads(m_numOfAvailableThreads) if(m_numOfAvailableThreads > 1 && numOfRows >= MinNumOfRowsPerTask)
+        for (int featureIndex = 0; featureIndex < features.GetNumOfColumns(); ++featureIndex) {
+            const auto featuresTableColumn = features.GetViewableTableColumnSpan(featureIndex);
+            const auto sortedRows = context.GetNodeSortedRows(featureIndex, 0, numOfRows);
+            std::ranges::copy(context.Rows, sortedRows.begin());
+            std::ranges::stable_sort(sortedRows, [featuresTableColumn](int a, int b){ return featuresTableColumn[a] < featuresTableColumn[b]; });
+        }
+    }
+
+    int DecisionTreeRegressor::PartitionNodeRows(
+        const DataContainers::TableView<double>& features,
+        int firstRowIndex,
+        int numOfRows,
+        const SplittingParameters& splittingParameters,
+        FitContext& context) const
+    {
+        const auto [bestFeatureIndex, bestValue] = splittingParameters;
+        const auto bestFeatureTableColumn = features.GetViewableTableColumnSpan(bestFeatureIndex);
+        const int numOfLeftRows = StablePartitionRows(context.GetNodeRows(firstRowIndex, numOfRows), bestFeatureTableColumn, bestValue,
+                                                      context.SplitScratches.local().RightRows);
+        if (context.SortedRows.empty())
+            return numOfLeftRows;
+
+        const auto partitionSortedRows = [&](int featureIndex) {
+            [[maybe_unused]] const int numOfSortedLeftRows = StablePartitionRows(context.GetNodeSortedRows(featureIndex, firstRowIndex, numOfRows), bestFeatureTableColumn,
+                                                                bestValue, context.SplitScratches.local().RightRows);
+            assert(numOfSortedLeftRows == numOfLeftRows);
+        };
+
+        if (m_numOfAvailableThreads > 1 && numOfRows >= MinNumOfRowsPerTask)
+            tbb::parallel_for(0, features.GetNumOfColumns(), partitionSortedRows);
+        else
+            for (int featureIndex = 0; featureIndex < features.GetNumOfColumns(); ++featureIndex)
+                partitionSortedRows(featureIndex);
+
+        return numOfLeftRows;
+    }
+
+    int DecisionTreeRegressor::StablePartitionRows(std::span<int> rows, std::span<const double> featuresTableColumn, double splittingValue, std::vector<int>& rightRows) {
+        // Both children keep the order of the rows, so the sorted rows of a feature stay sorted
+        rightRows.clear();
+        int numOfLeftRows = 0;
+        for (auto row : rows) {
+            if (featuresTableColumn[row] > splittingValue)
+                rightRows.push_back(row);
+            else
+                rows[numOfLeftRows++] = row;
+        }
+        std::ranges::copy(rightRows, rows.begin() + numOfLeftRows);
+
+        return numOfLeftRows;
+    }
+
+    void DecisionTreeRegressor::BuildFlatTree(const BuildNode& root, int numOfPredictedValues) {
+        m_flatTree = FlatDecisionTree(numOfPredictedValues);
+
+        std::vector<const BuildNode*> nodes{&root};
+        for (int nodeIndex = 0; nodeIndex < std::ssize(nodes); ++nodeIndex) {
+            const auto* node = nodes[nodeIndex];
+            const auto [bestFeatureIndex, bestValue] = node->Splitting;
+            if (bestFeatureIndex == -1) {
+                m_flatTree.AddLeafNode(node->LeafValues);
+                continue;
+            }
+
+            m_flatTree.AddSplitNode(bestFeatureIndex, bestValue, std::ssize(nodes));
+            nodes.push_back(node->LeftChild);
+            nodes.push_back(node->RightChild);
+        }
+    }
+
+    void DecisionTreeRegressor::CalculateMovingAverage(const std::vector<double>& column, const std::vector<int>& sortedColumnElemIndexes, SplitScratch& scratch) {
+        auto& uniqueColumnElem = scratch.UniqueValues;
+        uniqueColumnElem.clear();
+        for (auto i : sortedColumnElemIndexes)
+            if (uniqueColumnElem.empty() || uniqueColumnElem.back() != column[i])
+                uniqueColumnElem.push_back(column[i]);
+
+        auto& res = scratch.MovingAverage;
+        res.assign(std::max(0, static_cast<int>(std::ssize(uniqueColumnElem)) - WindowSize + 1), 0.0);
         for (int i = 0; i < std::ssize(res); ++i) {
-            auto elemBunch = std::views::counted(std::ranges::begin(uniqueColumnElem) + i, WindowSize);
-            res[i] = std::accumulate(std::ranges::begin(elemBunch), std::ranges::end(elemBunch), 0.0,
+            auto elemBunch = std::span(uniqueColumnElem).subspan(i, WindowSize);
+            res[i] = std::accumulate(elemBunch.begin(), elemBunch.end(), 0.0,
                                       [](double res, double val){ return res + val / WindowSize; });
         }
+    }
 
-        return res;
+    DecisionTreeRegressor::SortedFeatureRows DecisionTreeRegressor::GetSortedFeatureRows(const DataContainers::TableView<double>& features) const {
+        SortedFeatureRows sortedFeatureRows(features.GetNumOfColumns());
+
+        #pragma omp parallel for num_threads(m_numOfAvailableThreads) if(m_numOfAvailableThreads > 1 && features.GetNumOfRows() >= MinNumOfRowsPerTask)
+        for (int featureIndex = 0; featureIndex < features.GetNumOfColumns(); ++featureIndex) {
+            std::vector<double> featuresColumn(features.GetNumOfRows());
+            features.GetColumn(featureIndex, featuresColumn.begin());
+            std::vector<int> rowIndexes(featuresColumn.size());
+            std::iota(rowIndexes.begin(), rowIndexes.end(), 0);
+            std::ranges::stable_sort(rowIndexes, [&featuresColumn](int a, int b){ return featuresColumn[a] < featuresColumn[b]; });
+
+            sortedFeatureRows[featureIndex] = rowIndexes
+                | std::views::transform([&features](int i){ return features.GetViewableTableRowIndex(i); })
+                | RangesUtils::to_vector;
+        }
+
+        return sortedFeatureRows;
+    }
+
+    void DecisionTreeRegressor::MergeSortedFeatureRows(const DataContainers::TableView<double>& features, int firstNewRowIndex, SortedFeatureRows& sortedFeatureRows) const {
+        #pragma omp parallel for num_threads(m_numOfAvailableThreads) if(m_numOfAvailableThreads > 1 && features.GetNumOfRows() >= MinNumOfRowsPerTask)
+        for (int featureIndex = 0; featureIndex < features.GetNumOfColumns(); ++featureIndex) {
+            const auto featuresTableColumn = features.GetViewableTableColumnSpan(featureIndex);
+            const auto byValue = [featuresTableColumn](int a, int b){ return featuresTableColumn[a] < featuresTableColumn[b]; };
+
+            auto& rows = sortedFeatureRows[featureIndex];
+            const auto numOfSortedRows = std::ssize(rows);
+            for (int rowIndex = firstNewRowIndex; rowIndex < features.GetNumOfRows(); ++rowIndex)
+                rows.push_back(features.GetViewableTableRowIndex(rowIndex));
+
+            // Stable on both steps, so ties keep the view order GetSortedFeatureRows gives them
+            std::stable_sort(rows.begin() + numOfSortedRows, rows.end(), byValue);
+            std::inplace_merge(rows.begin(), rows.begin() + numOfSortedRows, rows.end(), byValue);
+        }
     }
 
-    std::vector<int> DecisionTreeRegressor::GetRandomSubsetOfFeatures(int numOfFeatures) const {
+    std::vector<int> DecisionTreeRegressor::GetRandomSubsetOfFeatures(int numOfFeatures, std::uint64_t randomStream) const {
         const auto subsetSize = std::max(1, static_cast<int>((double)numOfFeatures * c_proportionOfFeaturesUsed));
         std::vector<int> subset(subsetSize);
-        std::ranges::sample(std::ranges::views::iota(0, numOfFeatures), subset.begin(), subsetSize, RandomGenerators::ThreadSafeRandom::Generator);
+        RandomGenerators::PhiloxRandom generator(m_randomSeed, randomStream);
+        std::ranges::sample(std::ranges::views::iota(0, numOfFeatures), subset.begin(), subsetSize, generator);
 
         return subset;
     }
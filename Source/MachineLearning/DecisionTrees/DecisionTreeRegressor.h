@@ -2,69 +2,259 @@
 #define DECISION_TREE_2_DECISIONTREEREGRESSOR_H
 
 #include <MachineLearning/RegressionModel.h>
+#include <MachineLearning/Datasets/StreamingDatasetSource.h>
+#include <MachineLearning/DecisionTrees/QuantizedFeatures.h>
+#include <MachineLearning/DecisionTrees/FlatDecisionTree.h>
 #include <memory>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <string>
+
+namespace MachineLearning::Ensembles {
+    class RandomForestRegressor;
+    class GradientBoostingRegressor;
+}
 
 namespace MachineLearning::DecisionTrees {
+    enum class SplittingMode {
+        Exact,
+        PresortedExact,
+        Histogram
+    };
+
     class DecisionTreeRegressor final : public RegressionModel {
+        friend class Ensembles::RandomForestRegressor;
+        friend class Ensembles::GradientBoostingRegressor;
+
     public:
+        static constexpr int DefaultStreamingChunkSize = 1 << 16;
+
         explicit DecisionTreeRegressor(
             int maxDepth = 5,
             int minSampleSize = 20,
             double proportionOfFeaturesUsed = 1.0,
-            int numOfAvailableThreads = 1
+            int numOfAvailableThreads = 1,
+            SplittingMode splittingMode = SplittingMode::Exact,
+            int maxNumOfBins = 255
         );
 
         DecisionTreeRegressor(DecisionTreeRegressor&& other) noexcept = default;
         ~DecisionTreeRegressor() override = default;
 
         void Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) override;
+        /// Row i of the dataset counts as sampleWeights[i] rows, so bootstraps can be fitted as counts of the original rows.
+        /// Rows of zero weight are left out, empty weights fit every row once. Weights must be whole numbers, since the minimum sample size
+        /// is compared with the total weight of a node's rows
+        void Fit(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset, std::span<const double> sampleWeights);
+        /// Histogram fit on features quantized beforehand, so that ensembles quantize their features once for all trees
+        void Fit(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            const QuantizedFeatures& quantizedFeatures,
+            std::span<const double> sampleWeights);
+        /// Keeps presorted rows and quantized features between calls and only sorts in or quantizes the appended rows.
+        /// Bin bounds are recalculated once the dataset doubles in size
+        void FitIncrementally(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) override;
+
+        /// Grows the tree level by level on histograms, reading the source once per level so only one chunk is resident at a time.
+        /// Bin bounds come from a strided sample of larger sources, so the tree may differ from one fitted in memory
+        void FitStreaming(const Datasets::StreamingDatasetSource& source, int chunkSize = DefaultStreamingChunkSize);
 
         [[nodiscard]] std::vector<double> Predict(const std::vector<double>& features) const override;
         [[nodiscard]] DataContainers::Table<double> Predict(const DataContainers::TableView<double>& features) const override;
 
+        void SetRandomSeed(std::uint64_t seed) override { m_randomSeed = seed; }
+        [[nodiscard]] std::unique_ptr<RegressionModel> CreateUnfittedCopy() const override;
+
+        [[nodiscard]] const FlatDecisionTree& GetFlatTree() const { return m_flatTree; }
+
+        void SaveToFile(const std::string& fileName) const;
+        /// Loaded tree reads its nodes straight from the mapped file
+        [[nodiscard]] static DecisionTreeRegressor LoadFromFile(const std::string& fileName);
+
     private:
+        using SortedFeatureRows = std::vector<std::vector<int>>;
+
         struct SplittingParameters {
             int BestFeatureIndex = -1;
             double BestValue = 0.0;
         };
 
-        struct ChildNodesTrainingDataset {
-            Datasets::SupervisedLearningDatasetView<double> LeftNodeDataset;
-            Datasets::SupervisedLearningDatasetView<double> RightNodeDataset;
+        struct BestSplit {
+            SplittingParameters Parameters;
+            double Mse = 0.0;
         };
 
-        DecisionTreeRegressor(
-            int maxDepth,
-            int minSampleSize,
-            double proportionOfFeaturesUsed,
+        struct NodeStatistics {
+            double SqrtOfN = 0.0;
+            double ObservationMeanSquareSum = 0.0;
+            std::vector<double> ObservationsMeanSums;
+            double Weight = 0.0;                ///< Total weight of the node rows
+        };
+
+        struct StreamingNode {
+            int NumOfRows = 0;
+            double ObservationSquareSum = 0.0;
+            std::vector<double> ObservationSums;
+            std::vector<int> BinSizes;          ///< Row counts indexed by feature and bin
+            std::vector<double> BinSums;        ///< Observation sums indexed by feature, bin and observation
+            SplittingParameters Splitting;
+            int LeftChildIndex = -1;            ///< Index of the left child in the level-ordered nodes, the right one follows it
+            std::uint64_t RandomStream = 0;     ///< Philox stream of the feature subsets, derived from the parent one as in GrowNode
+        };
+
+        /// Bins of every feature over the rows of a node. Sums are not scaled by the node, so the histogram of a child
+        /// is the histogram of its parent minus the one of its sibling
+        struct NodeHistogram {
+            std::vector<int> BinSizes;          ///< Row counts indexed by feature and bin
+            std::vector<double> BinWeights;     ///< Row weights indexed by feature and bin
+            std::vector<double> BinSums;        ///< Weighted observation sums indexed by feature, bin and observation
+        };
+
+        struct WarmStartState {
+            const DataContainers::Table<double>* FeaturesTable = nullptr;
+            int NumOfFeatures = 0;
+            int NumOfFittedRows = 0;
+            int NumOfQuantizedRows = 0;         ///< Number of rows the bin bounds were calculated from
+            std::optional<QuantizedFeatures> Quantized;
+            SortedFeatureRows SortedRows;
+        };
+
+        /// Node grown during one fit, the fit turns the grown nodes into the flat tree and releases them at once
+        struct BuildNode {
+            SplittingParameters Splitting;
+            std::vector<double> LeafValues;     ///< Mean observations, calculated for leaves only
+            BuildNode* LeftChild = nullptr;
+            BuildNode* RightChild = nullptr;
+        };
+
+        /// Per-thread buffers reused by every node a thread searches splits for
+        struct SplitScratch;
+        /// Row buffers partitioned by the nodes, per-thread node arenas and split scratches of one fit
+        struct FitContext;
+
+        void FitFromRoot(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            const QuantizedFeatures* quantizedFeatures,
+            const SortedFeatureRows& sortedFeatureRows,
+            std::span<const double> sampleWeights);
+        static void CheckSampleWeights(const DataContainers::TableView<double>& features, std::span<const double> sampleWeights);
+        void SetWeightedRows(const DataContainers::TableView<double>& features, std::span<const double> sampleWeights, FitContext& context) const;
+        /// The node owns the rows [firstRowIndex, firstRowIndex + numOfRows) of the fit buffers and draws from its own random stream.
+        /// In histogram mode an empty node histogram is accumulated from the rows
+        void GrowNode(
+            BuildNode& node,
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
             int depth,
-            int numOfAvailableThreads
-        );
+            std::uint64_t randomStream,
+            int firstRowIndex,
+            int numOfRows,
+            NodeHistogram histogram,
+            FitContext& context) const;
+
+        static void CalculateMeanObservations(
+            const DataContainers::TableView<double>& observations,
+            std::span<const int> rows,
+            std::span<const double> rowWeights,
+            double weightOfRows,
+            std::vector<double>& meanObservations);
+        [[nodiscard]] static double CalculateMSE(
+            const DataContainers::TableView<double>& observations,
+            std::span<const int> rows,
+            std::span<const double> rowWeights,
+            double weightOfRows,
+            const std::vector<double>& meanObservations);
+        static void CalculateMovingAverage(const std::vector<double>& column, const std::vector<int>& sortedColumnElemIndexes, SplitScratch& scratch);
+        [[nodiscard]] std::vector<int> GetRandomSubsetOfFeatures(int numOfFeatures, std::uint64_t randomStream) const;
+        [[nodiscard]] SortedFeatureRows GetSortedFeatureRows(const DataContainers::TableView<double>& features) const;
+        void MergeSortedFeatureRows(const DataContainers::TableView<double>& features, int firstNewRowIndex, SortedFeatureRows& sortedFeatureRows) const;
+
+        [[nodiscard]] static NodeStatistics GetNodeStatistics(
+            const DataContainers::TableView<double>& observations,
+            std::span<const int> rows,
+            std::span<const double> rowWeights,
+            double weightOfRows);
+        [[nodiscard]] static double GetSplitMse(
+            const NodeStatistics& nodeStatistics,
+            const std::vector<double>& leftMeanSums, double leftWeight,
+            const std::vector<double>& rightMeanSums, double rightWeight);
+
+        [[nodiscard]] SplittingParameters GetSplittingParameters(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            int firstRowIndex,
+            int numOfRows,
+            double weightOfRows,
+            double nodeMse,
+            std::uint64_t randomStream,
+            const NodeHistogram& histogram,
+            FitContext& context) const;
+        static void UpdateBestExactSplit(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            std::span<const int> rows,
+            std::span<const double> rowWeights,
+            int featureIndex,
+            const NodeStatistics& nodeStatistics,
+            SplitScratch& scratch,
+            BestSplit& bestSplit);
+        static void UpdateBestPresortedSplit(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            std::span<const int> sortedRows,
+            std::span<const double> rowWeights,
+            int featureIndex,
+            const NodeStatistics& nodeStatistics,
+            SplitScratch& scratch,
+            BestSplit& bestSplit);
+        void UpdateBestHistogramSplit(
+            const NodeHistogram& histogram,
+            const QuantizedFeatures& quantizedFeatures,
+            int featureIndex,
+            const NodeStatistics& nodeStatistics,
+            SplitScratch& scratch,
+            BestSplit& bestSplit) const;
+        static void UpdateBestSplitOverBins(
+            const QuantizedFeatures& quantizedFeatures,
+            int featureIndex,
+            std::span<const int> binSizes,
+            std::span<const double> binWeights,
+            std::span<const double> binMeanSums,
+            const NodeStatistics& nodeStatistics,
+            SplitScratch& scratch,
+            BestSplit& bestSplit);
+
+        [[nodiscard]] NodeHistogram AccumulateNodeHistogram(
+            const Datasets::SupervisedLearningDatasetView<double>& trainingDataset,
+            std::span<const int> rows,
+            FitContext& context) const;
+        static void AddNodeHistogram(NodeHistogram& histogram, const NodeHistogram& addend);
+        static void SubtractNodeHistogram(NodeHistogram& histogram, const NodeHistogram& subtrahend);
 
-        void FitImpl(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset);
+        [[nodiscard]] QuantizedFeatures GetStreamingQuantizedFeatures(const Datasets::StreamingDatasetSource& source, int chunkSize) const;
+        [[nodiscard]] SplittingParameters GetStreamingSplittingParameters(const StreamingNode& node, std::uint64_t randomStream, const QuantizedFeatures& quantizedFeatures) const;
 
-        [[nodiscard]] static std::vector<double> GetMeanObservations(const DataContainers::TableView<double>& observations);
-        [[nodiscard]] double GetMSE(const DataContainers::TableView<double>& observations) const;
-        [[nodiscard]] static std::vector<double> GetMovingAverage(const std::vector<double>& column, std::vector<int> sortedColumnElemIndexes);
-        [[nodiscard]] std::vector<int> GetRandomSubsetOfFeatures(int numOfFeatures) const;
+        /// Moves the rows of the left child to the front of the node ranges, returns their number
+        [[nodiscard]] int PartitionNodeRows(
+            const DataContainers::TableView<double>& features,
+            int firstRowIndex,
+            int numOfRows,
+            const SplittingParameters& splittingParameters,
+            FitContext& context) const;
+        [[nodiscard]] static int StablePartitionRows(std::span<int> rows, std::span<const double> featuresTableColumn, double splittingValue, std::vector<int>& rightRows);
 
-        [[nodiscard]] SplittingParameters GetSplittingParameters(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) const;
-        [[nodiscard]] ChildNodesTrainingDataset SplitTrainingDataset(const Datasets::SupervisedLearningDatasetView<double>& trainingDataset) const;
+        void BuildFlatTree(const BuildNode& root, int numOfPredictedValues);
 
-        [[nodiscard]] const std::vector<double>& PredictImpl(const std::ranges::random_access_range auto& featureRange) const;
+        [[nodiscard]] std::vector<double> GetSerializedParameters() const;
+        [[nodiscard]] static DecisionTreeRegressor CreateFromSerializedParameters(std::span<const double> parameters);
 
     private:
         const int c_maxDepth;
         const int c_minSampleSize;
         const double c_proportionOfFeaturesUsed;
+        const SplittingMode c_splittingMode;
+        const int c_maxNumOfBins;
         const int m_numOfAvailableThreads;
-        int m_curDepth = 0;
-        double m_nodeMse = 0.0;
-        std::vector<double> m_meanObservations;
-        std::unique_ptr<DecisionTreeRegressor> m_leftNode;
-        std::unique_ptr<DecisionTreeRegressor> m_rightNode;
-        SplittingParameters m_splittingParameters;
+        std::uint64_t m_randomSeed;
+        FlatDecisionTree m_flatTree;
+        std::unique_ptr<WarmStartState> m_warmStartState;
     };
 }
 
@@ -0,0 +1,148 @@
+#include "FlatDecisionTree.h"
+#include <stdexcept>
+#include <MachineLearning/DecisionTrees/TreeTraversalKernels.h>
+
+namespace MachineLearning::DecisionTrees {
+    FlatDecisionTree::FlatDecisionTree(int numOfPredictedValues)
+        : m_numOfPredictedValues(numOfPredictedValues)
+    {
+        if (numOfPredictedValues <= 0)
+            throw std::invalid_argument("Number of predicted values is less than or equal to zero");
+    }
+
+    FlatDecisionTree::FlatDecisionTree(
+        std::shared_ptr<const void> storageOwner,
+        int numOfPredictedValues,
+        std::span<const int> featureIndexes,
+        std::span<const double> thresholds,
+        std::span<const int> childOffsets,
+        std::span<const double> leafValues)
+        : m_numOfPredictedValues(numOfPredictedValues)
+        , m_featureIndexes(featureIndexes)
+        , m_thresholds(thresholds)
+        , m_childOffsets(childOffsets)
+        , m_leafValues(leafValues)
+        , m_mappedStorageOwner(std::move(storageOwner))
+    {
+        if (m_mappedStorageOwner == nullptr)
+            throw std::invalid_argument("Storage owner of the tree is not set");
+
+        CheckNodes();
+    }
+
+    FlatDecisionTree::FlatDecisionTree(const FlatDecisionTree& other)
+        : m_numOfPredictedValues(other.m_numOfPredictedValues)
+        , m_ownedFeatureIndexes(other.m_ownedFeatureIndexes)
+        , m_ownedThresholds(other.m_ownedThresholds)
+        , m_ownedChildOffsets(other.m_ownedChildOffsets)
+        , m_ownedLeafValues(other.m_ownedLeafValues)
+        , m_mappedStorageOwner(other.m_mappedStorageOwner)
+    {
+        BindStorage(other);
+    }
+
+    FlatDecisionTree::FlatDecisionTree(FlatDecisionTree&& other) noexcept
+        : m_numOfPredictedValues(other.m_numOfPredictedValues)
+        , m_ownedFeatureIndexes(std::move(other.m_ownedFeatureIndexes))
+        , m_ownedThresholds(std::move(other.m_ownedThresholds))
+        , m_ownedChildOffsets(std::move(other.m_ownedChildOffsets))
+        , m_ownedLeafValues(std::move(other.m_ownedLeafValues))
+        , m_mappedStorageOwner(std::move(other.m_mappedStorageOwner))
+    {
+        BindStorage(other);
+        other.BindStorage(other);
+    }
+
+    FlatDecisionTree& FlatDecisionTree::operator=(const FlatDecisionTree& other) {
+        if (this != &other)
+            *this = FlatDecisionTree(other);
+
+        return *this;
+    }
+
+    FlatDecisionTree& FlatDecisionTree::operator=(FlatDecisionTree&& other) noexcept {
+        if (this == &other)
+            return *this;
+
+        m_numOfPredictedValues = other.m_numOfPredictedValues;
+        m_ownedFeatureIndexes = std::move(other.m_ownedFeatureIndexes);
+        m_ownedThresholds = std::move(other.m_ownedThresholds);
+        m_ownedChildOffsets = std::move(other.m_ownedChildOffsets);
+        m_ownedLeafValues = std::move(other.m_ownedLeafValues);
+        m_mappedStorageOwner = std::move(other.m_mappedStorageOwner);
+        BindStorage(other);
+        other.BindStorage(other);
+
+        return *this;
+    }
+
+    void FlatDecisionTree::AddSplitNode(int featureIndex, double threshold, int leftChildIndex) {
+        if (IsStorageMapped())
+            throw std::logic_error("Mapped tree can not be modified");
+
+        if (featureIndex < 0)
+            throw std::invalid_argument("Feature index is less than zero");
+
+        m_ownedFeatureIndexes.push_back(featureIndex);
+        m_ownedThresholds.push_back(threshold);
+        m_ownedChildOffsets.push_back(leftChildIndex);
+        BindStorage(*this);
+    }
+
+    void FlatDecisionTree::AddLeafNode(std::span<const double> leafValues) {
+        if (IsStorageMapped())
+            throw std::logic_error("Mapped tree can not be modified");
+
+        if (std::ssize(leafValues) != m_numOfPredictedValues)
+            throw std::invalid_argument("Number of leaf values is not equal to number of predicted values");
+
+        m_ownedFeatureIndexes.push_back(LeafFeatureIndex);
+        m_ownedThresholds.push_back(0.0);
+        m_ownedChildOffsets.push_back(std::ssize(m_ownedLeafValues) / m_numOfPredictedValues);
+        m_ownedLeafValues.insert(m_ownedLeafValues.end(), leafValues.begin(), leafValues.end());
+        BindStorage(*this);
+    }
+
+    void FlatDecisionTree::FindLeafNodes(std::span<const double> columnMajorFeatures, int numOfRows, std::span<int> leafNodeIndexes) const {
+        if (m_featureIndexes.empty())
+            return;
+
+        TreeTraversalKernels::FindLeafNodes({m_featureIndexes.data(), m_thresholds.data(), m_childOffsets.data()},
+                                            columnMajorFeatures.data(), numOfRows, numOfRows, leafNodeIndexes.data());
+    }
+
+    void FlatDecisionTree::BindStorage(const FlatDecisionTree& source) {
+        if (m_mappedStorageOwner != nullptr) {
+            m_featureIndexes = source.m_featureIndexes;
+            m_thresholds = source.m_thresholds;
+            m_childOffsets = source.m_childOffsets;
+            m_leafValues = source.m_leafValues;
+            return;
+        }
+
+        m_featureIndexes = m_ownedFeatureIndexes;
+        m_thresholds = m_ownedThresholds;
+        m_childOffsets = m_ownedChildOffsets;
+        m_leafValues = m_ownedLeafValues;
+    }
+
+    void FlatDecisionTree::CheckNodes() const {
+        if (m_numOfPredictedValues <= 0)
+            throw std::invalid_argument("Number of predicted values is less than or equal to zero");
+
+        const auto numOfNodes = m_featureIndexes.size();
+        if (numOfNodes == 0 || m_thresholds.size() != numOfNodes || m_childOffsets.size() != numOfNodes || m_leafValues.size() % m_numOfPredictedValues != 0)
+            throw std::invalid_argument("Sizes of tree node arrays do not match");
+
+        const auto numOfLeaves = static_cast<long long>(m_leafValues.size() / m_numOfPredictedValues);
+        for (std::size_t nodeIndex = 0; nodeIndex < numOfNodes; ++nodeIndex) {
+            const long long childOffset = m_childOffsets[nodeIndex];
+            const bool isNodeValid = m_featureIndexes[nodeIndex] == LeafFeatureIndex
+                ? childOffset >= 0 && childOffset < numOfLeaves
+                : m_featureIndexes[nodeIndex] >= 0 && childOffset > static_cast<long long>(nodeIndex) && childOffset + 1 < static_cast<long long>(numOfNodes);
+
+            if (!isNodeValid)
+                throw std::invalid_argument("Tree node refers out of the tree");
+        }
+    }
+}
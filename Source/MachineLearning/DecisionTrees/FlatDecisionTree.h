@@ -0,0 +1,89 @@
+#ifndef DECISION_TREE_2_FLATDECISIONTREE_H
+#define DECISION_TREE_2_FLATDECISIONTREE_H
+
+#include <vector>
+#include <span>
+#include <ranges>
+#include <memory>
+
+namespace MachineLearning::DecisionTrees {
+    class FlatDecisionTree {
+    public:
+        static constexpr int LeafFeatureIndex = -1;
+
+        FlatDecisionTree() = default;
+        explicit FlatDecisionTree(int numOfPredictedValues);
+
+        /// Read-only tree over external node arrays, e.g. a mapped model file, which are kept alive by the storage owner
+        FlatDecisionTree(
+            std::shared_ptr<const void> storageOwner,
+            int numOfPredictedValues,
+            std::span<const int> featureIndexes,
+            std::span<const double> thresholds,
+            std::span<const int> childOffsets,
+            std::span<const double> leafValues);
+
+        FlatDecisionTree(const FlatDecisionTree& other);
+        FlatDecisionTree(FlatDecisionTree&& other) noexcept;
+        FlatDecisionTree& operator=(const FlatDecisionTree& other);
+        FlatDecisionTree& operator=(FlatDecisionTree&& other) noexcept;
+        ~FlatDecisionTree() = default;
+
+        [[nodiscard]] int GetNumOfNodes() const { return std::ssize(m_featureIndexes); }
+        [[nodiscard]] int GetNumOfPredictedValues() const { return m_numOfPredictedValues; }
+
+        [[nodiscard]] bool IsLeaf(int nodeIndex) const { return m_featureIndexes[nodeIndex] == LeafFeatureIndex; }
+        [[nodiscard]] int GetFeatureIndex(int nodeIndex) const { return m_featureIndexes[nodeIndex]; }
+        [[nodiscard]] double GetThreshold(int nodeIndex) const { return m_thresholds[nodeIndex]; }
+        [[nodiscard]] int GetLeftChildIndex(int nodeIndex) const { return m_childOffsets[nodeIndex]; }
+        [[nodiscard]] int GetRightChildIndex(int nodeIndex) const { return m_childOffsets[nodeIndex] + 1; }
+        [[nodiscard]] std::span<const double> GetLeafValues(int nodeIndex) const {
+            return m_leafValues.subspan(m_childOffsets[nodeIndex] * m_numOfPredictedValues, m_numOfPredictedValues);
+        }
+
+        [[nodiscard]] bool IsStorageMapped() const { return m_mappedStorageOwner != nullptr; }
+        [[nodiscard]] std::span<const int> GetFeatureIndexes() const { return m_featureIndexes; }
+        [[nodiscard]] std::span<const double> GetThresholds() const { return m_thresholds; }
+        [[nodiscard]] std::span<const int> GetChildOffsets() const { return m_childOffsets; }
+        [[nodiscard]] std::span<const double> GetAllLeafValues() const { return m_leafValues; }
+
+        void AddSplitNode(int featureIndex, double threshold, int leftChildIndex);
+        void AddLeafNode(std::span<const double> leafValues);
+
+        /// No values for a tree without nodes, e.g. of a model yet to be fitted
+        template<std::ranges::random_access_range Range>
+        [[nodiscard]] std::span<const double> Predict(const Range& featureRange) const {
+            if (m_featureIndexes.empty())
+                return {};
+
+            auto featureIterator = std::ranges::begin(featureRange);
+
+            int nodeIndex = 0;
+            for (int featureIndex = m_featureIndexes[0]; featureIndex != LeafFeatureIndex; featureIndex = m_featureIndexes[nodeIndex])
+                nodeIndex = m_childOffsets[nodeIndex] + (featureIterator[featureIndex] > m_thresholds[nodeIndex]);
+
+            return GetLeafValues(nodeIndex);
+        }
+
+        /// Finds no leaves for a tree without nodes
+        void FindLeafNodes(std::span<const double> columnMajorFeatures, int numOfRows, std::span<int> leafNodeIndexes) const;
+
+    private:
+        void BindStorage(const FlatDecisionTree& source);
+        void CheckNodes() const;
+
+    private:
+        int m_numOfPredictedValues = 0;                     ///< Number of values stored in every leaf
+        std::span<const int> m_featureIndexes;              ///< Splitting feature of every node, LeafFeatureIndex for leaves
+        std::span<const double> m_thresholds;               ///< Splitting threshold of every node
+        std::span<const int> m_childOffsets;                ///< Left child index of split nodes (right child follows it), leaf index of leaves
+        std::span<const double> m_leafValues;               ///< Row-major matrix of leaf predictions
+        std::vector<int> m_ownedFeatureIndexes;             ///< Storage of m_featureIndexes for trees built in memory
+        std::vector<double> m_ownedThresholds;              ///< Storage of m_thresholds for trees built in memory
+        std::vector<int> m_ownedChildOffsets;               ///< Storage of m_childOffsets for trees built in memory
+        std::vector<double> m_ownedLeafValues;              ///< Storage of m_leafValues for trees built in memory
+        std::shared_ptr<const void> m_mappedStorageOwner;   ///< Keeps the external node arrays alive, nullptr for trees built in memory
+    };
+}
+
+#endif
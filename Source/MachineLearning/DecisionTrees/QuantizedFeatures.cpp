@@ -0,0 +1,75 @@
+#include "QuantizedFeatures.h"
+#include <algorithm>
+#include <ranges>
+
+namespace MachineLearning::DecisionTrees {
+    QuantizedFeatures::QuantizedFeatures(const DataContainers::TableView<double>& features, int maxNumOfBins)
+        : m_numOfViewableTableRows(features.GetNumOfViewableTableRows())
+        , m_binUpperBounds(features.GetNumOfColumns())
+        , m_binIndexes(static_cast<std::size_t>(features.GetNumOfColumns()) * m_numOfViewableTableRows, 0)
+    {
+        if (maxNumOfBins < 2 || maxNumOfBins > MaxNumOfBins)
+            throw std::invalid_argument("Invalid number of bins");
+
+        for (int featureIndex = 0; featureIndex < features.GetNumOfColumns(); ++featureIndex) {
+            std::vector<double> featuresColumn(features.GetNumOfRows());
+            features.GetColumn(featureIndex, featuresColumn.begin());
+            m_binUpperBounds[featureIndex] = CalculateBinUpperBounds(featuresColumn, maxNumOfBins);
+
+            for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex)
+                m_binIndexes[static_cast<std::size_t>(featureIndex) * m_numOfViewableTableRows + features.GetViewableTableRowIndex(rowIndex)] =
+                    Quantize(featureIndex, featuresColumn[rowIndex]);
+        }
+    }
+
+    void QuantizedFeatures::AddViewableRows(const DataContainers::TableView<double>& features, int firstRowIndex) {
+        if (features.GetNumOfColumns() != GetNumOfFeatures())
+            throw std::invalid_argument("Number of features doesn't coincide with the quantized ones");
+
+        const int numOfViewableTableRows = features.GetNumOfViewableTableRows();
+        if (numOfViewableTableRows > m_numOfViewableTableRows) {
+            std::vector<BinIndex> binIndexes(static_cast<std::size_t>(GetNumOfFeatures()) * numOfViewableTableRows, 0);
+            for (int featureIndex = 0; featureIndex < GetNumOfFeatures(); ++featureIndex)
+                std::ranges::copy(std::span(m_binIndexes).subspan(static_cast<std::size_t>(featureIndex) * m_numOfViewableTableRows, m_numOfViewableTableRows),
+                                  binIndexes.begin() + static_cast<std::ptrdiff_t>(featureIndex) * numOfViewableTableRows);
+
+            m_binIndexes = std::move(binIndexes);
+            m_numOfViewableTableRows = numOfViewableTableRows;
+        }
+
+        for (int featureIndex = 0; featureIndex < GetNumOfFeatures(); ++featureIndex) {
+            const auto column = features.GetViewableTableColumnSpan(featureIndex);
+            for (int rowIndex = firstRowIndex; rowIndex < features.GetNumOfRows(); ++rowIndex) {
+                const int viewableTableRowIndex = features.GetViewableTableRowIndex(rowIndex);
+                m_binIndexes[static_cast<std::size_t>(featureIndex) * m_numOfViewableTableRows + viewableTableRowIndex] = Quantize(featureIndex, column[viewableTableRowIndex]);
+            }
+        }
+    }
+
+    QuantizedFeatures::BinIndex QuantizedFeatures::Quantize(int featureIndex, double value) const {
+        const auto& upperBounds = m_binUpperBounds[featureIndex];
+        return static_cast<BinIndex>(std::distance(upperBounds.begin(), std::ranges::lower_bound(upperBounds, value)));
+    }
+
+    std::vector<double> QuantizedFeatures::CalculateBinUpperBounds(std::vector<double> values, int maxNumOfBins) {
+        std::ranges::sort(values);
+
+        const auto numOfValueBoundaries = std::ranges::count_if(std::views::iota(1, static_cast<int>(values.size())),
+                                                                [&values](int i){ return values[i - 1] != values[i]; });
+        const bool isEveryValueInOwnBin = numOfValueBoundaries < maxNumOfBins;
+        const double binCapacity = (double)values.size() / (double)maxNumOfBins;
+
+        std::vector<double> upperBounds;
+        for (int i = 1; i < std::ssize(values) && std::ssize(upperBounds) < maxNumOfBins - 1; ++i) {
+            if (values[i - 1] == values[i])
+                continue;
+
+            if (!isEveryValueInOwnBin && (double)i < (double)(upperBounds.size() + 1) * binCapacity)
+                continue;
+
+            upperBounds.push_back(values[i - 1] / 2. + values[i] / 2.);
+        }
+
+        return upperBounds;
+    }
+}
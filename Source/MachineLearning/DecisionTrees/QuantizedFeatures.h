@@ -0,0 +1,41 @@
+#ifndef DECISION_TREE_2_QUANTIZEDFEATURES_H
+#define DECISION_TREE_2_QUANTIZEDFEATURES_H
+
+#include <vector>
+#include <cstdint>
+#include <DataContainers/TableView.h>
+
+namespace MachineLearning::DecisionTrees {
+    class QuantizedFeatures {
+    public:
+        using BinIndex = std::uint8_t;
+
+        static constexpr int MaxNumOfBins = 256;
+
+        QuantizedFeatures(const DataContainers::TableView<double>& features, int maxNumOfBins);
+
+        [[nodiscard]] int GetNumOfFeatures() const { return std::ssize(m_binUpperBounds); }
+        [[nodiscard]] int GetNumOfViewableTableRows() const { return m_numOfViewableTableRows; }
+        [[nodiscard]] int GetNumOfBins(int featureIndex) const { return std::ssize(m_binUpperBounds[featureIndex]) + 1; }
+
+        [[nodiscard]] double GetBinUpperBound(int featureIndex, int binIndex) const { return m_binUpperBounds[featureIndex][binIndex]; }
+        [[nodiscard]] BinIndex GetBinIndex(int viewableTableRowIndex, int featureIndex) const {
+            return m_binIndexes[static_cast<std::size_t>(featureIndex) * m_numOfViewableTableRows + viewableTableRowIndex];
+        }
+
+        [[nodiscard]] BinIndex Quantize(int featureIndex, double value) const;
+
+        /// Quantizes view rows from firstRowIndex on with the bin bounds already calculated
+        void AddViewableRows(const DataContainers::TableView<double>& features, int firstRowIndex);
+
+    private:
+        [[nodiscard]] static std::vector<double> CalculateBinUpperBounds(std::vector<double> values, int maxNumOfBins);
+
+    private:
+        int m_numOfViewableTableRows = 0;                      ///< Number of rows in the table behind the quantized view
+        std::vector<std::vector<double>> m_binUpperBounds;     ///< Per feature split thresholds between neighbouring bins
+        std::vector<BinIndex> m_binIndexes;                    ///< Column-major bin indexes addressed by viewable table row
+    };
+}
+
+#endif
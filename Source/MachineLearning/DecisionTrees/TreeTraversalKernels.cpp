@@ -0,0 +1,177 @@
+#include "TreeTraversalKernels.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define DECISION_TREE_2_X86_KERNELS
+#endif
+
+namespace MachineLearning::DecisionTrees::TreeTraversalKernels {
+    namespace {
+        inline int FindLeafNode(const TreeNodes& tree, const double* row, int stride) {
+            int nodeIndex = 0;
+            for (int featureIndex = tree.FeatureIndexes[0]; featureIndex >= 0; featureIndex = tree.FeatureIndexes[nodeIndex])
+                nodeIndex = tree.ChildOffsets[nodeIndex] + (row[featureIndex * stride] > tree.Thresholds[nodeIndex]);
+
+            return nodeIndex;
+        }
+
+        using FindLeafNodesFunction = void (*)(const TreeNodes&, const double*, int, int, int*);
+
+        FindLeafNodesFunction GetBestFindLeafNodesFunction() {
+        #ifdef DECISION_TREE_2_X86_KERNELS
+            return IsAvx2Supported() ? FindLeafNodesAvx2 : FindLeafNodesSse2;
+        #else
+            return FindLeafNodesScalar;
+        #endif
+        }
+    }
+
+    void FindLeafNodes(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes) {
+        static const auto findLeafNodes = GetBestFindLeafNodesFunction();
+        findLeafNodes(tree, features, stride, numOfRows, leafNodeIndexes);
+    }
+
+    void FindLeafNodesScalar(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes) {
+        for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+            leafNodeIndexes[rowIndex] = FindLeafNode(tree, features + rowIndex, stride);
+    }
+
+#ifdef DECISION_TREE_2_X86_KERNELS
+    bool IsAvx2Supported() {
+        return __builtin_cpu_supports("avx2");
+    }
+
+    namespace {
+        inline __m128i AdvanceNodesSse2(const TreeNodes& tree, const double* rows, int stride, __m128i nodeIndexes, __m128i& isActive) {
+            alignas(16) int nodes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(nodes), nodeIndexes);
+
+            const __m128i featureIndexes = _mm_setr_epi32(tree.FeatureIndexes[nodes[0]], tree.FeatureIndexes[nodes[1]],
+                                                          tree.FeatureIndexes[nodes[2]], tree.FeatureIndexes[nodes[3]]);
+            isActive = _mm_cmpgt_epi32(featureIndexes, _mm_set1_epi32(-1));
+
+            alignas(16) int activeFeatureIndexes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(activeFeatureIndexes), _mm_and_si128(featureIndexes, isActive));
+
+            const __m128d lowIsGreater = _mm_cmpgt_pd(_mm_setr_pd(rows[activeFeatureIndexes[0] * stride], rows[activeFeatureIndexes[1] * stride + 1]),
+                                                      _mm_setr_pd(tree.Thresholds[nodes[0]], tree.Thresholds[nodes[1]]));
+            const __m128d highIsGreater = _mm_cmpgt_pd(_mm_setr_pd(rows[activeFeatureIndexes[2] * stride + 2], rows[activeFeatureIndexes[3] * stride + 3]),
+                                                       _mm_setr_pd(tree.Thresholds[nodes[2]], tree.Thresholds[nodes[3]]));
+            const __m128i isGreater = _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(lowIsGreater), _mm_castpd_ps(highIsGreater), _MM_SHUFFLE(2, 0, 2, 0)));
+
+            const __m128i childIndexes = _mm_sub_epi32(_mm_setr_epi32(tree.ChildOffsets[nodes[0]], tree.ChildOffsets[nodes[1]],
+                                                                      tree.ChildOffsets[nodes[2]], tree.ChildOffsets[nodes[3]]), isGreater);
+            return _mm_or_si128(_mm_and_si128(isActive, childIndexes), _mm_andnot_si128(isActive, nodeIndexes));
+        }
+    }
+
+    void FindLeafNodesSse2(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes) {
+        constexpr int NumOfLanes = 4;
+        constexpr int NumOfGroups = 2;
+
+        int rowIndex = 0;
+        for (; rowIndex + NumOfLanes * NumOfGroups <= numOfRows; rowIndex += NumOfLanes * NumOfGroups) {
+            __m128i lowNodeIndexes = _mm_setzero_si128();
+            __m128i highNodeIndexes = _mm_setzero_si128();
+            __m128i isLowActive, isHighActive;
+            do {
+                lowNodeIndexes = AdvanceNodesSse2(tree, features + rowIndex, stride, lowNodeIndexes, isLowActive);
+                highNodeIndexes = AdvanceNodesSse2(tree, features + rowIndex + NumOfLanes, stride, highNodeIndexes, isHighActive);
+            } while (_mm_movemask_epi8(_mm_or_si128(isLowActive, isHighActive)) != 0);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(leafNodeIndexes + rowIndex), lowNodeIndexes);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(leafNodeIndexes + rowIndex + NumOfLanes), highNodeIndexes);
+        }
+
+        FindLeafNodesScalar(tree, features + rowIndex, stride, numOfRows - rowIndex, leafNodeIndexes + rowIndex);
+    }
+
+    namespace {
+        struct Avx2Constants {
+            __m256i LeafFeatureIndexes;
+            __m256i Strides;
+            __m256i LaneOffsets;
+            __m256d AllLanes;
+        };
+
+        __attribute__((target("avx2")))
+        inline __m256i AdvanceNodesAvx2(const TreeNodes& tree, const double* rows, const Avx2Constants& constants, __m256i nodeIndexes, __m256i& isActive) {
+            const __m256i featureIndexes = _mm256_i32gather_epi32(tree.FeatureIndexes, nodeIndexes, 4);
+            const __m256i childOffsets = _mm256_i32gather_epi32(tree.ChildOffsets, nodeIndexes, 4);
+            const __m256d lowThresholds = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), tree.Thresholds, _mm256_castsi256_si128(nodeIndexes), constants.AllLanes, 8);
+            const __m256d highThresholds = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), tree.Thresholds, _mm256_extracti128_si256(nodeIndexes, 1), constants.AllLanes, 8);
+            isActive = _mm256_cmpgt_epi32(featureIndexes, constants.LeafFeatureIndexes);
+
+            const __m256i valueOffsets = _mm256_add_epi32(_mm256_mullo_epi32(featureIndexes, constants.Strides), constants.LaneOffsets);
+            const __m256d lowValues = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), rows, _mm256_castsi256_si128(valueOffsets),
+                                                               _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(isActive))), 8);
+            const __m256d highValues = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), rows, _mm256_extracti128_si256(valueOffsets, 1),
+                                                                _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(isActive, 1))), 8);
+
+            const __m256 isGreaterPairs = _mm256_shuffle_ps(_mm256_castpd_ps(_mm256_cmp_pd(lowValues, lowThresholds, _CMP_GT_OQ)),
+                                                            _mm256_castpd_ps(_mm256_cmp_pd(highValues, highThresholds, _CMP_GT_OQ)),
+                                                            _MM_SHUFFLE(2, 0, 2, 0));
+            const __m256i isGreater = _mm256_permute4x64_epi64(_mm256_castps_si256(isGreaterPairs), _MM_SHUFFLE(3, 1, 2, 0));
+
+            return _mm256_blendv_epi8(nodeIndexes, _mm256_sub_epi32(childOffsets, isGreater), isActive);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void FindLeafNodesAvx2(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes) {
+        constexpr int NumOfLanes = 8;
+        constexpr int NumOfGroups = 4;
+
+        const Avx2Constants constants{
+            _mm256_set1_epi32(-1),
+            _mm256_set1_epi32(stride),
+            _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+            _mm256_castsi256_pd(_mm256_set1_epi64x(-1))
+        };
+
+        int rowIndex = 0;
+        for (; rowIndex + NumOfLanes * NumOfGroups <= numOfRows; rowIndex += NumOfLanes * NumOfGroups) {
+            __m256i nodeIndexes[NumOfGroups];
+            __m256i isActive[NumOfGroups];
+            for (int group = 0; group < NumOfGroups; ++group)
+                nodeIndexes[group] = _mm256_setzero_si256();
+
+            bool isAnyActive = true;
+            while (isAnyActive) {
+                for (int group = 0; group < NumOfGroups; ++group)
+                    nodeIndexes[group] = AdvanceNodesAvx2(tree, features + rowIndex + group * NumOfLanes, constants, nodeIndexes[group], isActive[group]);
+
+                const __m256i isActiveInAnyGroup = _mm256_or_si256(_mm256_or_si256(isActive[0], isActive[1]), _mm256_or_si256(isActive[2], isActive[3]));
+                isAnyActive = !_mm256_testz_si256(isActiveInAnyGroup, isActiveInAnyGroup);
+            }
+
+            for (int group = 0; group < NumOfGroups; ++group)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(leafNodeIndexes + rowIndex + group * NumOfLanes), nodeIndexes[group]);
+        }
+
+        for (; rowIndex + NumOfLanes <= numOfRows; rowIndex += NumOfLanes) {
+            __m256i nodeIndexes = _mm256_setzero_si256();
+            __m256i isActive;
+            do {
+                nodeIndexes = AdvanceNodesAvx2(tree, features + rowIndex, constants, nodeIndexes, isActive);
+            } while (!_mm256_testz_si256(isActive, isActive));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(leafNodeIndexes + rowIndex), nodeIndexes);
+        }
+
+        FindLeafNodesSse2(tree, features + rowIndex, stride, numOfRows - rowIndex, leafNodeIndexes + rowIndex);
+    }
+#else
+    bool IsAvx2Supported() {
+        return false;
+    }
+
+    void FindLeafNodesSse2(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes) {
+        FindLeafNodesScalar(tree, features, stride, numOfRows, leafNodeIndexes);
+    }
+
+    void FindLeafNodesAvx2(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes) {
+        FindLeafNodesScalar(tree, features, stride, numOfRows, leafNodeIndexes);
+    }
+#endif
+}
@@ -0,0 +1,22 @@
+#ifndef DECISION_TREE_2_TREETRAVERSALKERNELS_H
+#define DECISION_TREE_2_TREETRAVERSALKERNELS_H
+
+namespace MachineLearning::DecisionTrees::TreeTraversalKernels {
+    struct TreeNodes {
+        const int* FeatureIndexes = nullptr;    ///< Negative for leaves
+        const double* Thresholds = nullptr;
+        const int* ChildOffsets = nullptr;      ///< Left child index of split nodes, right child follows it
+    };
+
+    /// Walks numOfRows rows of a column-major features block (value of row r and feature f is at f * stride + r)
+    /// through the tree and writes the reached leaf node indexes. Uses the widest kernel the CPU supports.
+    void FindLeafNodes(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes);
+
+    void FindLeafNodesScalar(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes);
+    void FindLeafNodesSse2(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes);
+    void FindLeafNodesAvx2(const TreeNodes& tree, const double* features, int stride, int numOfRows, int* leafNodeIndexes);
+
+    [[nodiscard]] bool IsAvx2Supported();
+}
+
+#endif
@@ -1,15 +1,24 @@
 #include "AdaBoostRegressor.h"
 #include <algorithm>
-#include <random>
 #include <cmath>
 #include <execution>
-#include <RandomGenerators/RegularRandom.h>
+#include <array>
+#include <numeric>
+#include <RandomGenerators/PhiloxRandom.h>
+#include <MachineLearning/Utils/BatchPredictionUtils.h>
+#include <MachineLearning/Utils/ModelSerializationUtils.h>
+
+namespace {
+    constexpr int BootstrapBlockSize = 1 << 14;
+    constexpr int ReductionBlockSize = 1 << 12;
+}
 
 namespace MachineLearning::Ensembles {
     AdaBoostRegressor::AdaBoostRegressor(int maxNumOfTrees, int numOfAvailableThreads)
             : m_maxNumOfTrees(maxNumOfTrees)
             , m_numOfAvailableThreads(numOfAvailableThreads)
             , m_numOfPredictedValues(0)
+            , m_randomSeed(RandomGenerators::PhiloxRandom::GetNondeterministicSeed())
             , m_totalTreesWeight(0.)
     {
         if (maxNumOfTrees <= 0)
@@ -20,56 +29,153 @@ namespace MachineLearning::Ensembles {
         ClearMemory();
         ReserveMemory();
 
-        const auto &[features, observations] = dataset;
-        m_numOfPredictedValues = observations.GetNumOfColumns();
-        std::vector<double> sampleWeights(features.GetNumOfRows(), 1.0);
+        m_numOfPredictedValues = dataset.Observations.GetNumOfColumns();
+        m_numOfFittedRows = dataset.Features.GetNumOfRows();
+        std::vector<double> sampleWeights(m_numOfFittedRows, 1.0);
 
-        for (int i = 0; i < m_maxNumOfTrees; ++i) {
-            const auto sampleProbabilities = CalculateSampleProbabilities(sampleWeights);
+        BoostTrees(dataset, DecisionTrees::DecisionStumpRegressor::GetPresortedFeatures(dataset.Features), sampleWeights);
+        m_totalTreesWeight = std::reduce(std::execution::unseq, m_treeWeights.cbegin(), m_treeWeights.cend(), 0., std::plus());
+        UpdateLeafLengthsSquares();
+    }
 
-            auto &tree = m_trees.emplace_back(1, 2, 1.0, m_numOfAvailableThreads);
-            tree.Fit(CreateBootstrappedDataset(dataset, sampleProbabilities));
-            const auto predictions = tree.Predict(features);
+    void AdaBoostRegressor::FitIncrementally(const Datasets::SupervisedLearningDatasetView<double> &dataset) {
+        const int numOfRows = dataset.Features.GetNumOfRows();
+        if (m_numOfFittedRows == 0 || m_numOfFittedRows >= numOfRows || m_numOfPredictedValues != dataset.Observations.GetNumOfColumns()) {
+            Fit(dataset);
+            return;
+        }
 
-            const auto sampleLosses = CalculateSampleLosses(observations, predictions);
-            const double meanLoss = std::transform_reduce(std::execution::par_unseq, sampleLosses.cbegin(), sampleLosses.cend(), sampleProbabilities.cbegin(),
-                                                          0.0, std::plus(),
-                                                          std::multiplies());
-            const double beta = CalculateBeta(meanLoss);
-            m_treeWeights.push_back(CalculateTreeWeight(beta));
+        const int numOfTrees = std::ssize(m_trees);
+        const int numOfRefittedTrees = std::clamp(static_cast<int>(std::ceil((double)numOfTrees * (numOfRows - m_numOfFittedRows) / numOfRows)), 1, numOfTrees);
+        while (std::ssize(m_trees) > numOfTrees - numOfRefittedTrees)
+            m_trees.pop_back();
 
-            if (meanLoss >= 0.5)
-                break;
+        m_treeWeights.clear();
+        m_numOfFittedRows = numOfRows;
+        std::vector<double> sampleWeights(numOfRows, 1.0);
 
-            UpdateSampleWeights(sampleWeights, sampleLosses, beta);
+        bool isBoostingStopped = false;
+        for (int treeIndex = 0; treeIndex < std::ssize(m_trees) && !isBoostingStopped; ++treeIndex)
+            isBoostingStopped = !WeighTree(m_trees[treeIndex], dataset, sampleWeights);
+
+        while (std::ssize(m_trees) > std::ssize(m_treeWeights))
+            m_trees.pop_back();
+
+        if (!isBoostingStopped)
+            BoostTrees(dataset, DecisionTrees::DecisionStumpRegressor::GetPresortedFeatures(dataset.Features), sampleWeights);
+
+        m_totalTreesWeight = std::reduce(std::execution::unseq, m_treeWeights.cbegin(), m_treeWeights.cend(), 0., std::plus());
+        UpdateLeafLengthsSquares();
+    }
+
+    void AdaBoostRegressor::BoostTrees(
+            const Datasets::SupervisedLearningDatasetView<double>& dataset,
+            const DecisionTrees::DecisionStumpRegressor::PresortedFeatures& presortedFeatures,
+            std::vector<double>& sampleWeights)
+    {
+        while (std::ssize(m_trees) < m_maxNumOfTrees) {
+            const RandomGenerators::AliasTable rowSampler(sampleWeights);
+
+            const int treeIndex = std::ssize(m_trees);
+            auto &tree = m_trees.emplace_back();
+            tree.Fit(dataset, presortedFeatures, CreateBootstrapCounts(rowSampler, treeIndex));
+
+            if (!WeighTree(tree, dataset, sampleWeights))
+                break;
         }
+    }
+
+    bool AdaBoostRegressor::WeighTree(
+            const DecisionTrees::DecisionStumpRegressor& tree,
+            const Datasets::SupervisedLearningDatasetView<double>& dataset,
+            std::vector<double>& sampleWeights)
+    {
+        const auto sampleLosses = CalculateSampleLosses(tree, dataset);
+        const double meanLoss = CalculateMeanLoss(sampleLosses, sampleWeights);
+        const double beta = CalculateBeta(meanLoss);
+        m_treeWeights.push_back(CalculateTreeWeight(beta));
 
-        m_totalTreesWeight = std::reduce(std::execution::par_unseq, m_treeWeights.cbegin(), m_treeWeights.cend(), 0., std::plus());
+        if (meanLoss >= 0.5)
+            return false;
+
+        UpdateSampleWeights(sampleWeights, sampleLosses, beta);
+        return true;
     }
 
-    std::vector<double> AdaBoostRegressor::Predict(const std::vector<double> &features) const {
-        DataContainers::Table<double> predictions;
-        predictions.SetNumOfColumns(m_numOfPredictedValues);
+    std::unique_ptr<RegressionModel> AdaBoostRegressor::CreateUnfittedCopy() const {
+        auto copy = std::make_unique<AdaBoostRegressor>(m_maxNumOfTrees, m_numOfAvailableThreads);
+        copy->SetRandomSeed(m_randomSeed);
+        return copy;
+    }
 
+    void AdaBoostRegressor::SaveToFile(const std::string& fileName) const {
+        if (m_trees.empty())
+            throw std::logic_error("Model is not fitted");
+
+        std::vector<DecisionTrees::FlatDecisionTree> flatTrees;
+        std::vector<const DecisionTrees::FlatDecisionTree*> trees;
+        flatTrees.reserve(m_trees.size());
         for (const auto& tree : m_trees)
-            predictions.PushBackRow(tree.Predict(features));
+            trees.push_back(&flatTrees.emplace_back(tree.ToFlatTree()));
 
-        return CalculateWeightedMedian(predictions);
+        const std::array parameters{static_cast<double>(m_maxNumOfTrees), static_cast<double>(m_numOfAvailableThreads)};
+        ModelSerializationUtils::SaveModelToFile(fileName, ModelSerializationUtils::ModelType::AdaBoost, m_numOfPredictedValues, parameters, trees, m_treeWeights);
     }
 
-    DataContainers::Table<double> AdaBoostRegressor::Predict(const DataContainers::TableView<double> &features) const {
-        DataContainers::Table<double> res;
-        res.SetNumOfColumns(m_numOfPredictedValues);
+    AdaBoostRegressor AdaBoostRegressor::LoadFromFile(const std::string& fileName) {
+        auto modelFile = ModelSerializationUtils::LoadModelFromFile(fileName, ModelSerializationUtils::ModelType::AdaBoost);
+        if (modelFile.Trees.empty() || modelFile.Parameters.size() != 2 || modelFile.TreeWeights.size() != modelFile.Trees.size())
+            throw std::invalid_argument("Invalid AdaBoost model file");
 
-        for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex)
-            res.PushBackRow(Predict(features.GetRow(rowIndex) | RangesUtils::to_vector));
+        AdaBoostRegressor model(static_cast<int>(modelFile.Parameters[0]), static_cast<int>(modelFile.Parameters[1]));
+        model.ReserveMemory();
+        model.m_numOfPredictedValues = modelFile.NumOfPredictedValues;
+        for (const auto& flatTree : modelFile.Trees)
+            model.m_trees.push_back(DecisionTrees::DecisionStumpRegressor::CreateFromFlatTree(flatTree));
 
-        return res;
+        model.m_treeWeights = std::move(modelFile.TreeWeights);
+        model.m_totalTreesWeight = std::reduce(std::execution::unseq, model.m_treeWeights.cbegin(), model.m_treeWeights.cend(), 0., std::plus());
+        model.UpdateLeafLengthsSquares();
+
+        return model;
+    }
+
+    std::vector<double> AdaBoostRegressor::Predict(const std::vector<double> &features) const {
+        // Reused by every call of the thread, so a prediction allocates only the returned values
+        thread_local std::vector<MedianCandidate> candidates;
+        candidates.resize(m_trees.size());
+        for (int treeIndex = 0; treeIndex < std::ssize(m_trees); ++treeIndex) {
+            const auto& tree = m_trees[treeIndex];
+            const bool isRightLeaf = !tree.IsLeaf() && features[tree.GetFeatureIndex()] > tree.GetThreshold();
+            candidates[treeIndex] = {m_leafLengthsSquares[2 * treeIndex + isRightLeaf], treeIndex};
+        }
+
+        const auto weightedMedian = m_trees[FindWeightedMedianTree(candidates)].PredictValues(features);
+        return {weightedMedian.begin(), weightedMedian.end()};
+    }
+
+    DataContainers::Table<double> AdaBoostRegressor::Predict(const DataContainers::TableView<double> &features) const {
+        return BatchPredictionUtils::PredictByRowBlocks(features, m_numOfPredictedValues,
+            [this, candidates = std::vector<MedianCandidate>(m_trees.size())]
+            (const BatchPredictionUtils::FeaturesBlock& featuresBlock, std::span<double> predictions) mutable {
+                const auto isRightLeaf = [&featuresBlock](const DecisionTrees::DecisionStumpRegressor& tree, int rowIndex) {
+                    return !tree.IsLeaf() && featuresBlock.Values[tree.GetFeatureIndex() * featuresBlock.NumOfRows + rowIndex] > tree.GetThreshold();
+                };
+
+                for (int rowIndex = 0; rowIndex < featuresBlock.NumOfRows; ++rowIndex) {
+                    for (int treeIndex = 0; treeIndex < std::ssize(m_trees); ++treeIndex)
+                        candidates[treeIndex] = {m_leafLengthsSquares[2 * treeIndex + isRightLeaf(m_trees[treeIndex], rowIndex)], treeIndex};
+
+                    const auto& medianTree = m_trees[FindWeightedMedianTree(candidates)];
+                    std::ranges::copy(medianTree.GetLeafValues(isRightLeaf(medianTree, rowIndex)), predictions.begin() + rowIndex * m_numOfPredictedValues);
+                }
+            });
     }
 
     void AdaBoostRegressor::ClearMemory() {
         m_trees.clear();
         m_treeWeights.clear();
+        m_leafLengthsSquares.clear();
     }
 
     void AdaBoostRegressor::ReserveMemory() {
@@ -77,75 +183,129 @@ namespace MachineLearning::Ensembles {
         m_trees.reserve(m_maxNumOfTrees);
     }
 
-    std::vector<double> AdaBoostRegressor::CalculateSampleProbabilities(const std::vector<double> &sampleWeights) {
-        std::vector<double> res(sampleWeights.size());
-        double sum = std::reduce(std::execution::par_unseq, sampleWeights.begin(), sampleWeights.end(), 0.0, std::plus());
-        std::transform(std::execution::par_unseq, sampleWeights.cbegin(), sampleWeights.cend(), res.begin(),
-                       [sum](double w){ return w / sum; });
-
-        return res;
-    }
-
-    Datasets::SupervisedLearningDatasetView<double> AdaBoostRegressor::CreateBootstrappedDataset(
-            const Datasets::SupervisedLearningDatasetView<double> &originalDataset,
-            const std::vector<double> &sampleProbabilities)
-    {
-        const auto& [originalFeatures, originalObservations] = originalDataset;
-        Datasets::SupervisedLearningDatasetView bootstrappedDataset(originalFeatures.GetViewableTable(), originalObservations.GetViewableTable());
-
-        std::discrete_distribution<int> distribution(sampleProbabilities.begin(), sampleProbabilities.end());
-        for (int i = 0; i < originalFeatures.GetNumOfRows(); ++i) {
-            const auto rowIndex = distribution(RandomGenerators::RegularRandom::Generator);
-            bootstrappedDataset.PushBackViewableRowIndex(originalFeatures.GetViewableTableRowIndex(rowIndex));
+    std::vector<double> AdaBoostRegressor::CreateBootstrapCounts(const RandomGenerators::AliasTable& rowSampler, int treeIndex) const {
+        const int numOfRows = rowSampler.GetSize();
+        const int numOfBlocks = (numOfRows + BootstrapBlockSize - 1) / BootstrapBlockSize;
+        // A tree boosted anew on more rows gets a fresh bootstrap
+        const auto bootstrapStream = RandomGenerators::PhiloxRandom::GetChildStream(treeIndex, numOfRows);
+        std::vector<int> drawnRows(numOfRows);
+
+        #pragma omp parallel for
+        for (int blockIndex = 0; blockIndex < numOfBlocks; ++blockIndex) {
+            RandomGenerators::PhiloxRandom generator(m_randomSeed, RandomGenerators::PhiloxRandom::GetChildStream(bootstrapStream, blockIndex));
+            const int lastDrawIndex = std::min(numOfRows, (blockIndex + 1) * BootstrapBlockSize);
+            for (int drawIndex = blockIndex * BootstrapBlockSize; drawIndex < lastDrawIndex; ++drawIndex)
+                drawnRows[drawIndex] = rowSampler(generator);
         }
 
-        return bootstrappedDataset;
+        std::vector<double> bootstrapCounts(numOfRows, 0.0);
+        for (int row : drawnRows)
+            ++bootstrapCounts[row];
+
+        return bootstrapCounts;
     }
 
     std::vector<double> AdaBoostRegressor::CalculateSampleLosses(
-            const DataContainers::TableView<double>& observations,
-            const DataContainers::TableView<double>& predictions)
+            const DecisionTrees::DecisionStumpRegressor& tree,
+            const Datasets::SupervisedLearningDatasetView<double>& dataset)
     {
-        std::vector<double> sampleLosses(observations.GetNumOfRows());
-
-        for (int rowIndex = 0; rowIndex < observations.GetNumOfRows(); ++rowIndex) {
-            const auto observationRow = observations.GetRow(rowIndex);
-            const auto predictionRow = predictions.GetRow(rowIndex);
-            sampleLosses[rowIndex] = std::transform_reduce(std::execution::par_unseq, observationRow.cbegin(), observationRow.cend(), predictionRow.cbegin(),
-                                                           0.0, std::plus(),
-                                                           [](double a, double b){ return (a - b) * (a - b); });
-            sampleLosses[rowIndex] = std::sqrt(sampleLosses[rowIndex]);
+        const auto &[features, observations] = dataset;
+        const int numOfRows = features.GetNumOfRows();
+        const auto featuresTableColumn = tree.IsLeaf() ? std::span<const double>() : features.GetViewableTableColumnSpan(tree.GetFeatureIndex());
+        std::vector<std::span<const double>> observationsTableColumns(observations.GetNumOfColumns());
+        for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex)
+            observationsTableColumns[columnIndex] = observations.GetViewableTableColumnSpan(columnIndex);
+
+        std::vector<double> sampleLosses(numOfRows);
+        double maxLoss = 0.0;
+
+        #pragma omp parallel for reduction(max: maxLoss)
+        for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex) {
+            const bool isRightLeaf = !tree.IsLeaf() && featuresTableColumn[features.GetViewableTableRowIndex(rowIndex)] > tree.GetThreshold();
+            const auto prediction = tree.GetLeafValues(isRightLeaf);
+            const int observationsRow = observations.GetViewableTableRowIndex(rowIndex);
+            double squaredLoss = 0.0;
+            for (int columnIndex = 0; columnIndex < std::ssize(observationsTableColumns); ++columnIndex) {
+                const double difference = observationsTableColumns[columnIndex][observationsRow] - prediction[columnIndex];
+                squaredLoss += difference * difference;
+            }
+
+            sampleLosses[rowIndex] = std::sqrt(squaredLoss);
+            maxLoss = std::max(maxLoss, sampleLosses[rowIndex]);
         }
 
-        std::transform(std::execution::par_unseq, sampleLosses.cbegin(), sampleLosses.cend(), sampleLosses.begin(),
-                       [maxLoss = *std::ranges::max_element(sampleLosses)]
-                       (double loss){ return 1. - std::exp(-loss / maxLoss); });
+        #pragma omp parallel for simd
+        for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+            sampleLosses[rowIndex] = 1. - std::exp(-sampleLosses[rowIndex] / maxLoss);
 
         return sampleLosses;
     }
 
-    std::vector<double> AdaBoostRegressor::CalculateWeightedMedian(const DataContainers::TableView<double>& predictions) const {
-        std::vector<int> sampleIndexes(predictions.GetNumOfRows());
-        std::iota(sampleIndexes.begin(), sampleIndexes.end(), 0);
-
-        std::vector<double> sampleLengthsSquares(sampleIndexes.size());
-        for (int i = 0; i < std::ssize(sampleLengthsSquares); ++i) {
-            const auto row = predictions.GetRow(i);
-            sampleLengthsSquares[i] = std::transform_reduce(row.cbegin(), row.cend(),
-                                                     0., std::plus(),
-                                                     [](double val){ return val * val; });
+    double AdaBoostRegressor::CalculateMeanLoss(const std::vector<double>& sampleLosses, const std::vector<double>& sampleWeights) {
+        const int numOfRows = std::ssize(sampleLosses);
+        const int numOfBlocks = (numOfRows + ReductionBlockSize - 1) / ReductionBlockSize;
+        std::vector<double> blockLossSums(numOfBlocks);
+        std::vector<double> blockWeightSums(numOfBlocks);
+
+        #pragma omp parallel for
+        for (int blockIndex = 0; blockIndex < numOfBlocks; ++blockIndex) {
+            const int firstRowIndex = blockIndex * ReductionBlockSize;
+            const int lastRowIndex = std::min(numOfRows, firstRowIndex + ReductionBlockSize);
+            double lossSum = 0.0;
+            double weightSum = 0.0;
+
+            #pragma omp simd reduction(+: lossSum, weightSum)
+            for (int rowIndex = firstRowIndex; rowIndex < lastRowIndex; ++rowIndex) {
+                lossSum += sampleLosses[rowIndex] * sampleWeights[rowIndex];
+                weightSum += sampleWeights[rowIndex];
+            }
+
+            blockLossSums[blockIndex] = lossSum;
+            blockWeightSums[blockIndex] = weightSum;
         }
 
-        std::ranges::sort(sampleIndexes, [&sampleLengthsSquares](int a, int b){ return sampleLengthsSquares[a] < sampleLengthsSquares[b]; });
-        const auto sortedTreeWeights = sampleIndexes | std::ranges::views::transform([this](int i){ return m_treeWeights[i]; });
+        return std::accumulate(blockLossSums.cbegin(), blockLossSums.cend(), 0.0)
+               / std::accumulate(blockWeightSums.cbegin(), blockWeightSums.cend(), 0.0);
+    }
 
-        int k = 0;
-        double sumOfWeights = m_totalTreesWeight - sortedTreeWeights[0];
+    void AdaBoostRegressor::UpdateLeafLengthsSquares() {
+        m_leafLengthsSquares.clear();
+        m_leafLengthsSquares.reserve(2 * m_trees.size());
+        for (const auto& tree : m_trees) {
+            for (bool isRightLeaf : {false, true}) {
+                double lengthSquared = 0.0;
+                for (double value : tree.GetLeafValues(isRightLeaf))
+                    lengthSquared += value * value;
+                m_leafLengthsSquares.push_back(lengthSquared);
+            }
+        }
+    }
 
-        while(k < std::ssize(sampleIndexes) - 1 && sumOfWeights > m_totalTreesWeight / 2.)
-            sumOfWeights -= sortedTreeWeights[++k];
+    int AdaBoostRegressor::FindWeightedMedianTree(std::span<MedianCandidate> candidates) const {
+        // The median is the first ranked tree such that the trees ranked after it weigh at most half of the total.
+        // Selection keeps only the candidates that may still be it, the ones ranked after them are summed up once
+        auto first = candidates.begin();
+        auto last = candidates.end();
+        double weightAfterLast = 0.0;
+
+        while (last - first > 1) {
+            const auto middle = first + (last - first - 1) / 2;
+            std::nth_element(first, middle, last);
+
+            double weightAfterMiddle = weightAfterLast;
+            for (auto candidate = middle + 1; candidate != last; ++candidate)
+                weightAfterMiddle += m_treeWeights[candidate->TreeIndex];
+
+            if (weightAfterMiddle <= m_totalTreesWeight / 2.) {
+                last = middle + 1;
+                weightAfterLast = weightAfterMiddle;
+            }
+            else {
+                first = middle + 1;
+            }
+        }
 
-        return predictions.GetRow(sampleIndexes[k]) | RangesUtils::to_vector;
+        return first->TreeIndex;
     }
 
     double AdaBoostRegressor::CalculateTreeWeight(double beta) {
@@ -157,8 +317,11 @@ namespace MachineLearning::Ensembles {
             const std::vector<double>& sampleLosses,
             double beta)
     {
+        const double logOfBeta = std::log(beta);
+
+        #pragma omp parallel for simd
         for (int i = 0; i < std::ssize(sampleWeights); ++i)
-            sampleWeights[i] *= std::pow(beta, 1. - sampleLosses[i]);
+            sampleWeights[i] *= std::exp(logOfBeta * (1. - sampleLosses[i]));
     }
 
     double AdaBoostRegressor::CalculateBeta(double meanLoss) {
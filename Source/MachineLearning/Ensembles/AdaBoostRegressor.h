@@ -2,8 +2,12 @@
 #define ADABOOSTREGRESSOR_H
 
 #include <vector>
+#include <string>
+#include <span>
+#include <compare>
 #include <MachineLearning/RegressionModel.h>
-#include <MachineLearning/DecisionTrees/DecisionTreeRegressor.h>
+#include <MachineLearning/DecisionTrees/DecisionStumpRegressor.h>
+#include <RandomGenerators/AliasTable.h>
 
 namespace MachineLearning::Ensembles {
     class AdaBoostRegressor final : public RegressionModel {
@@ -13,27 +17,66 @@ namespace MachineLearning::Ensembles {
             int numOfAvailableThreads = 1
         );
 
+        AdaBoostRegressor(AdaBoostRegressor&& other) noexcept = default;
         ~AdaBoostRegressor() override = default;
 
         void Fit(const Datasets::SupervisedLearningDatasetView<double> &dataset) override;
+        /// Reweighs the leading trees on the grown dataset without refitting them and boosts anew only the last ones,
+        /// as many as the proportion of appended rows. The kept stumps stay split on fewer rows, so the model only approximates the one Fit boosts
+        void FitIncrementally(const Datasets::SupervisedLearningDatasetView<double> &dataset) override;
 
         [[nodiscard]] std::vector<double> Predict(const std::vector<double> &features) const override;
         [[nodiscard]] DataContainers::Table<double> Predict(const DataContainers::TableView<double> &features) const override;
 
+        /// Bootstrap of every boosted stump draws from its own stream of the seed
+        void SetRandomSeed(std::uint64_t seed) override { m_randomSeed = seed; }
+        [[nodiscard]] std::unique_ptr<RegressionModel> CreateUnfittedCopy() const override;
+
+        [[nodiscard]] const std::vector<DecisionTrees::DecisionStumpRegressor>& GetTrees() const { return m_trees; }
+        [[nodiscard]] const std::vector<double>& GetTreeWeights() const { return m_treeWeights; }
+        [[nodiscard]] double GetTotalTreesWeight() const { return m_totalTreesWeight; }
+
+        void SaveToFile(const std::string& fileName) const;
+        /// Throws unless every tree of the file is a decision stump
+        [[nodiscard]] static AdaBoostRegressor LoadFromFile(const std::string& fileName);
+
     private:
+        struct MedianCandidate {
+            double LengthSquared = 0.0;         ///< Squared length of the tree prediction
+            int TreeIndex = 0;                  ///< Breaks ties between predictions of the same length
+
+            auto operator<=>(const MedianCandidate& other) const = default;
+        };
+
         void ClearMemory();
         void ReserveMemory();
 
-        [[nodiscard]] static std::vector<double> CalculateSampleProbabilities(const std::vector<double>& sampleWeights);
-        [[nodiscard]] Datasets::SupervisedLearningDatasetView<double> CreateBootstrappedDataset(
-                const Datasets::SupervisedLearningDatasetView<double>& originalDataset,
-                const std::vector<double>& sampleProbabilities);
+        /// Boosts trees up to the maximum number of them, sampleWeights hold the weights left by the last weighed tree
+        void BoostTrees(
+                const Datasets::SupervisedLearningDatasetView<double>& dataset,
+                const DecisionTrees::DecisionStumpRegressor::PresortedFeatures& presortedFeatures,
+                std::vector<double>& sampleWeights);
+        /// Appends the weight of the tree and updates sample weights, false when boosting has to stop at the tree
+        [[nodiscard]] bool WeighTree(
+                const DecisionTrees::DecisionStumpRegressor& tree,
+                const Datasets::SupervisedLearningDatasetView<double>& dataset,
+                std::vector<double>& sampleWeights);
+
+        /// Number of times every row is drawn into the bootstrap of the tree, as many draws as rows.
+        /// Every block of draws takes its own stream, so the counts don't depend on the number of threads
+        [[nodiscard]] std::vector<double> CreateBootstrapCounts(const RandomGenerators::AliasTable& rowSampler, int treeIndex) const;
 
+        /// Losses of the stump on every row, scaled by the largest one
         [[nodiscard]] static std::vector<double> CalculateSampleLosses(
-                const DataContainers::TableView<double>& observations,
-                const DataContainers::TableView<double>& predictions);
+                const DecisionTrees::DecisionStumpRegressor& tree,
+                const Datasets::SupervisedLearningDatasetView<double>& dataset);
+        /// Sums over fixed blocks of rows, so the mean is the same for any number of threads
+        [[nodiscard]] static double CalculateMeanLoss(const std::vector<double>& sampleLosses, const std::vector<double>& sampleWeights);
 
-        [[nodiscard]] std::vector<double> CalculateWeightedMedian(const DataContainers::TableView<double>& predictions) const;
+        /// Squared lengths of the left and the right leaf values of every tree, trees are ranked by the length of their prediction
+        void UpdateLeafLengthsSquares();
+        /// Tree whose prediction is the weighted median of the candidates, which are reordered in place
+        [[nodiscard]] int FindWeightedMedianTree(std::span<MedianCandidate> candidates) const;
 
         [[nodiscard]] static double CalculateTreeWeight(double beta);
         static void UpdateSampleWeights(std::vector<double>& sampleWeights, const std::vector<double>& sampleLosses, double beta);
@@ -43,9 +86,12 @@ namespace MachineLearning::Ensembles {
         const int m_maxNumOfTrees;
         const int m_numOfAvailableThreads;
         int m_numOfPredictedValues;
+        int m_numOfFittedRows = 0;
+        std::uint64_t m_randomSeed;
         double m_totalTreesWeight;
-        std::vector<DecisionTrees::DecisionTreeRegressor> m_trees;
+        std::vector<DecisionTrees::DecisionStumpRegressor> m_trees;
         std::vector<double> m_treeWeights;
+        std::vector<double> m_leafLengthsSquares;      ///< Left then right leaf of every tree, updated whenever the trees change
     };
 }
 
@@ -0,0 +1,187 @@
+#include "GradientBoostingRegressor.h"
+
+#include <algorithm>
+#include <array>
+#include <ranges>
+#include <RandomGenerators/PhiloxRandom.h>
+#include <MachineLearning/Utils/BatchPredictionUtils.h>
+#include <MachineLearning/Utils/ModelSerializationUtils.h>
+
+namespace MachineLearning::Ensembles {
+    GradientBoostingRegressor::GradientBoostingRegressor(int numOfTrees, double learningRate, double proportionOfRowsUsed, int maxDepth,
+        int minSampleSize, double proportionOfFeaturesUsed, int maxNumOfBins, int numOfAvailableThreads)
+        : c_learningRate(learningRate)
+        , c_proportionOfRowsUsed(proportionOfRowsUsed)
+    {
+        if (numOfTrees <= 0)
+            throw std::invalid_argument("Number of trees is less than zero");
+
+        if (c_learningRate <= 0. || c_learningRate > 1.)
+            throw std::invalid_argument("Invalid learning rate");
+
+        if (c_proportionOfRowsUsed <= 0. || c_proportionOfRowsUsed > 1.)
+            throw std::invalid_argument("Invalid proportion of rows used");
+
+        m_trees.reserve(numOfTrees);
+        for (int i = 0; i < numOfTrees; ++i)
+            m_trees.emplace_back(maxDepth, minSampleSize, proportionOfFeaturesUsed, numOfAvailableThreads,
+                                 DecisionTrees::SplittingMode::Histogram, maxNumOfBins);
+
+        SetRandomSeed(RandomGenerators::PhiloxRandom::GetNondeterministicSeed());
+    }
+
+    void GradientBoostingRegressor::Fit(const Datasets::SupervisedLearningDatasetView<double>& dataset) {
+        const auto& [features, observations] = dataset;
+        const int numOfRows = features.GetNumOfRows();
+        if (numOfRows == 0)
+            throw std::invalid_argument("Dataset is empty");
+
+        m_numOfPredictedValues = observations.GetNumOfColumns();
+        m_initialPredictions.assign(m_numOfPredictedValues, 0.0);
+        for (int columnIndex = 0; columnIndex < m_numOfPredictedValues; ++columnIndex)
+            for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+                m_initialPredictions[columnIndex] += observations.AtUnchecked(rowIndex, columnIndex) / numOfRows;
+
+        // Residuals are stored at the viewable table rows of the features, so the trees read features, bins and residuals by the same rows
+        DataContainers::Table<double> residuals(features.GetNumOfViewableTableRows(), m_numOfPredictedValues);
+        DataContainers::TableView<double> residualsView(residuals);
+        for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+            residualsView.PushBackViewableRowIndex(features.GetViewableTableRowIndex(rowIndex));
+        const Datasets::SupervisedLearningDatasetView<double> residualsDataset(features, residualsView);
+
+        const DecisionTrees::QuantizedFeatures quantizedFeatures(features, m_trees.front().c_maxNumOfBins);
+
+        DataContainers::Table<double> predictions(numOfRows, m_numOfPredictedValues);
+        for (int columnIndex = 0; columnIndex < m_numOfPredictedValues; ++columnIndex)
+            std::ranges::fill(predictions.GetColumnSpan(columnIndex), m_initialPredictions[columnIndex]);
+
+        for (int treeIndex = 0; treeIndex < std::ssize(m_trees); ++treeIndex) {
+            for (int columnIndex = 0; columnIndex < m_numOfPredictedValues; ++columnIndex) {
+                const auto residualsColumn = residuals.GetColumnSpan(columnIndex);
+                const auto observationsColumn = observations.GetViewableTableColumnSpan(columnIndex);
+                const auto predictionsColumn = std::as_const(predictions).GetColumnSpan(columnIndex);
+
+                #pragma omp parallel for
+                for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex) {
+                    const int row = features.GetViewableTableRowIndex(rowIndex);
+                    residualsColumn[row] = observationsColumn[row] - predictionsColumn[rowIndex];
+                }
+            }
+
+            auto& tree = m_trees[treeIndex];
+            tree.Fit(residualsDataset, quantizedFeatures, CreateSubsampleWeights(numOfRows, treeIndex));
+
+            const auto treePredictions = tree.Predict(features);
+            for (int columnIndex = 0; columnIndex < m_numOfPredictedValues; ++columnIndex) {
+                const auto predictionsColumn = predictions.GetColumnSpan(columnIndex);
+                const auto treePredictionsColumn = treePredictions.GetColumnSpan(columnIndex);
+
+                #pragma omp parallel for
+                for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+                    predictionsColumn[rowIndex] += c_learningRate * treePredictionsColumn[rowIndex];
+            }
+        }
+    }
+
+    void GradientBoostingRegressor::SetRandomSeed(std::uint64_t seed) {
+        m_randomSeed = seed;
+        for (int treeIndex = 0; treeIndex < std::ssize(m_trees); ++treeIndex)
+            m_trees[treeIndex].SetRandomSeed(RandomGenerators::PhiloxRandom::GetChildStream(seed, treeIndex));
+    }
+
+    std::unique_ptr<RegressionModel> GradientBoostingRegressor::CreateUnfittedCopy() const {
+        const auto& tree = m_trees.front();
+        auto copy = std::make_unique<GradientBoostingRegressor>(std::ssize(m_trees), c_learningRate, c_proportionOfRowsUsed, tree.c_maxDepth,
+                                                                tree.c_minSampleSize, tree.c_proportionOfFeaturesUsed, tree.c_maxNumOfBins,
+                                                                tree.m_numOfAvailableThreads);
+        copy->SetRandomSeed(m_randomSeed);
+        return copy;
+    }
+
+    void GradientBoostingRegressor::SaveToFile(const std::string& fileName) const {
+        if (m_numOfPredictedValues == 0)
+            throw std::logic_error("Model is not fitted");
+
+        std::vector<const DecisionTrees::FlatDecisionTree*> trees;
+        for (const auto& tree : m_trees)
+            trees.push_back(&tree.GetFlatTree());
+
+        // Initial predictions go between the boosting parameters and the tree ones, their number is the number of predicted values
+        std::vector<double> parameters{c_learningRate, c_proportionOfRowsUsed};
+        parameters.insert(parameters.end(), m_initialPredictions.begin(), m_initialPredictions.end());
+        const auto treeParameters = m_trees.front().GetSerializedParameters();
+        parameters.insert(parameters.end(), treeParameters.begin(), treeParameters.end());
+        ModelSerializationUtils::SaveModelToFile(fileName, ModelSerializationUtils::ModelType::GradientBoosting, m_numOfPredictedValues, parameters, trees);
+    }
+
+    GradientBoostingRegressor GradientBoostingRegressor::LoadFromFile(const std::string& fileName) {
+        auto modelFile = ModelSerializationUtils::LoadModelFromFile(fileName, ModelSerializationUtils::ModelType::GradientBoosting);
+        const int numOfBoostingParameters = 2 + modelFile.NumOfPredictedValues;
+        if (modelFile.Trees.empty() || std::ssize(modelFile.Parameters) < numOfBoostingParameters)
+            throw std::invalid_argument("Invalid gradient boosting model file");
+
+        const double learningRate = modelFile.Parameters[0];
+        const double proportionOfRowsUsed = modelFile.Parameters[1];
+        const auto treeParameters = std::span(modelFile.Parameters).subspan(numOfBoostingParameters);
+        const auto tree = DecisionTrees::DecisionTreeRegressor::CreateFromSerializedParameters(treeParameters);
+
+        GradientBoostingRegressor model(std::ssize(modelFile.Trees), learningRate, proportionOfRowsUsed, tree.c_maxDepth, tree.c_minSampleSize,
+                                        tree.c_proportionOfFeaturesUsed, tree.c_maxNumOfBins, tree.m_numOfAvailableThreads);
+        model.m_numOfPredictedValues = modelFile.NumOfPredictedValues;
+        model.m_initialPredictions.assign(modelFile.Parameters.begin() + 2, modelFile.Parameters.begin() + numOfBoostingParameters);
+        for (int treeIndex = 0; treeIndex < std::ssize(modelFile.Trees); ++treeIndex)
+            model.m_trees[treeIndex].m_flatTree = std::move(modelFile.Trees[treeIndex]);
+
+        return model;
+    }
+
+    std::vector<double> GradientBoostingRegressor::Predict(const std::vector<double>& features) const {
+        std::vector<double> res = m_initialPredictions;
+
+        for (const auto& tree : m_trees) {
+            const auto predictedValues = tree.GetFlatTree().Predict(features);
+            std::ranges::transform(res, predictedValues, res.begin(), [this](double res, double val){ return res + c_learningRate * val; });
+        }
+
+        return res;
+    }
+
+    DataContainers::Table<double> GradientBoostingRegressor::Predict(const DataContainers::TableView<double>& features) const {
+        return BatchPredictionUtils::PredictByRowBlocks(features, m_numOfPredictedValues,
+            [this](const BatchPredictionUtils::FeaturesBlock& featuresBlock, std::span<double> predictions) {
+                std::array<int, BatchPredictionUtils::RowBlockSize> leafNodeIndexes{};
+
+                for (int rowIndex = 0; rowIndex < featuresBlock.NumOfRows; ++rowIndex)
+                    std::ranges::copy(m_initialPredictions, predictions.begin() + rowIndex * m_numOfPredictedValues);
+
+                for (const auto& tree : m_trees) {
+                    const auto& flatTree = tree.GetFlatTree();
+                    flatTree.FindLeafNodes(featuresBlock.Values, featuresBlock.NumOfRows, leafNodeIndexes);
+
+                    for (int rowIndex = 0; rowIndex < featuresBlock.NumOfRows; ++rowIndex) {
+                        const auto rowPredictions = predictions.subspan(rowIndex * m_numOfPredictedValues, m_numOfPredictedValues);
+                        std::ranges::transform(rowPredictions, flatTree.GetLeafValues(leafNodeIndexes[rowIndex]), rowPredictions.begin(),
+                                               [this](double res, double val){ return res + c_learningRate * val; });
+                    }
+                }
+            });
+    }
+
+    std::vector<double> GradientBoostingRegressor::CreateSubsampleWeights(int numOfRows, int treeIndex) const {
+        if (c_proportionOfRowsUsed == 1.)
+            return {};
+
+        const auto numOfSubsampledRows = std::max(1, static_cast<int>((double)numOfRows * c_proportionOfRowsUsed));
+        // A tree refitted on more rows gets a fresh subsample
+        RandomGenerators::PhiloxRandom generator(m_randomSeed, RandomGenerators::PhiloxRandom::GetChildStream(treeIndex, numOfRows));
+
+        std::vector<int> subsampledRows(numOfSubsampledRows);
+        std::ranges::sample(std::views::iota(0, numOfRows), subsampledRows.begin(), numOfSubsampledRows, generator);
+
+        std::vector<double> subsampleWeights(numOfRows, 0.0);
+        for (auto row : subsampledRows)
+            subsampleWeights[row] = 1.0;
+
+        return subsampleWeights;
+    }
+}
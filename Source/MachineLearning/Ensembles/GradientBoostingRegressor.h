@@ -0,0 +1,62 @@
+#ifndef DECISION_TREE_2_GRADIENTBOOSTINGREGRESSOR_H
+#define DECISION_TREE_2_GRADIENTBOOSTINGREGRESSOR_H
+
+#include <vector>
+#include <string>
+#include <MachineLearning/RegressionModel.h>
+#include <MachineLearning/DecisionTrees/DecisionTreeRegressor.h>
+
+namespace MachineLearning::Ensembles {
+    /// Squared error boosting: every histogram tree is fitted on the residuals of the trees before it and adds its
+    /// predictions shrunk by the learning rate. Outputs share the trees, every leaf holds the mean residual of each output
+    class GradientBoostingRegressor final : public RegressionModel {
+    public:
+        explicit GradientBoostingRegressor(
+            int numOfTrees = 100,
+            double learningRate = 0.1,
+            double proportionOfRowsUsed = 1.0,
+            int maxDepth = 3,
+            int minSampleSize = 20,
+            double proportionOfFeaturesUsed = 1.0,
+            int maxNumOfBins = 255,
+            int numOfAvailableThreads = 1
+        );
+
+        GradientBoostingRegressor(GradientBoostingRegressor&& other) noexcept = default;
+        ~GradientBoostingRegressor() override = default;
+
+        /// Features are quantized once for all trees
+        void Fit(const Datasets::SupervisedLearningDatasetView<double>& dataset) override;
+
+        [[nodiscard]] std::vector<double> Predict(const std::vector<double>& features) const override;
+        [[nodiscard]] DataContainers::Table<double> Predict(const DataContainers::TableView<double>& features) const override;
+
+        /// Trees are seeded with streams of the seed, the row subsample of every tree draws from its own stream
+        void SetRandomSeed(std::uint64_t seed) override;
+        [[nodiscard]] std::unique_ptr<RegressionModel> CreateUnfittedCopy() const override;
+
+        [[nodiscard]] const std::vector<DecisionTrees::DecisionTreeRegressor>& GetTrees() const { return m_trees; }
+        [[nodiscard]] double GetLearningRate() const { return c_learningRate; }
+        /// Mean observations of the training dataset, which the trees correct
+        [[nodiscard]] const std::vector<double>& GetInitialPredictions() const { return m_initialPredictions; }
+
+        void SaveToFile(const std::string& fileName) const;
+        /// Loaded trees read their nodes straight from the mapped file
+        [[nodiscard]] static GradientBoostingRegressor LoadFromFile(const std::string& fileName);
+
+    private:
+        /// Weight of one for the rows drawn without replacement into the subsample of the tree and zero for the others,
+        /// empty when every row is used
+        [[nodiscard]] std::vector<double> CreateSubsampleWeights(int numOfRows, int treeIndex) const;
+
+    private:
+        const double c_learningRate;
+        const double c_proportionOfRowsUsed;
+        int m_numOfPredictedValues = 0;
+        std::uint64_t m_randomSeed = 0;
+        std::vector<double> m_initialPredictions;
+        std::vector<DecisionTrees::DecisionTreeRegressor> m_trees;
+    };
+}
+
+#endif
@@ -1,12 +1,15 @@
 #include "RandomForestRegressor.h"
 
 #include <algorithm>
-#include <RandomGenerators/ThreadSafeRandom.h>
-#include <RangesUtils/ToVectorRangeAdaptor.h>
+#include <array>
+#include <cmath>
+#include <RandomGenerators/PhiloxRandom.h>
+#include <MachineLearning/Utils/BatchPredictionUtils.h>
+#include <MachineLearning/Utils/ModelSerializationUtils.h>
 
 namespace MachineLearning::Ensembles {
     RandomForestRegressor::RandomForestRegressor(int numOfTrees, double proportionOfRowsUsed, int maxDepth, int minSampleSize,
-        double proportionOfFeaturesUsed)
+        double proportionOfFeaturesUsed, DecisionTrees::SplittingMode splittingMode, int maxNumOfBins)
         : c_proportionOfRowsUsed(proportionOfRowsUsed)
         , m_numOfPredictedValues(0)
     {
@@ -18,15 +21,85 @@ namespace MachineLearning::Ensembles {
 
         m_trees.reserve(numOfTrees);
         for (int i = 0; i < numOfTrees; ++i)
-           m_trees.emplace_back(maxDepth, minSampleSize, proportionOfFeaturesUsed);
+           m_trees.emplace_back(maxDepth, minSampleSize, proportionOfFeaturesUsed, 1, splittingMode, maxNumOfBins);
+
+        SetRandomSeed(RandomGenerators::PhiloxRandom::GetNondeterministicSeed());
     }
 
     void RandomForestRegressor::Fit(const Datasets::SupervisedLearningDatasetView<double>& dataset) {
         m_numOfPredictedValues = dataset.Observations.GetNumOfColumns();
 
+        m_numOfFittedRows = dataset.Features.GetNumOfRows();
+        m_nextRefittedTreeIndex = 0;
+
+        #pragma omp parallel for
+        for (int treeIndex = 0; treeIndex < std::ssize(m_trees); ++treeIndex)
+            m_trees[treeIndex].Fit(dataset, CreateBootstrapCounts(m_numOfFittedRows, treeIndex));
+    }
+
+    void RandomForestRegressor::FitIncrementally(const Datasets::SupervisedLearningDatasetView<double>& dataset) {
+        const int numOfRows = dataset.Features.GetNumOfRows();
+        if (m_numOfFittedRows == 0 || m_numOfFittedRows >= numOfRows || m_numOfPredictedValues != dataset.Observations.GetNumOfColumns()) {
+            Fit(dataset);
+            return;
+        }
+
+        const int numOfTrees = std::ssize(m_trees);
+        const int numOfRefittedTrees = std::clamp(static_cast<int>(std::ceil((double)numOfTrees * (numOfRows - m_numOfFittedRows) / numOfRows)), 1, numOfTrees);
+
         #pragma omp parallel for
-        for (auto &tree : m_trees)
-            tree.Fit(CreateBootstrappedDataset(dataset));
+        for (int i = 0; i < numOfRefittedTrees; ++i) {
+            const int treeIndex = (m_nextRefittedTreeIndex + i) % numOfTrees;
+            m_trees[treeIndex].Fit(dataset, CreateBootstrapCounts(numOfRows, treeIndex));
+        }
+
+        m_numOfFittedRows = numOfRows;
+        m_nextRefittedTreeIndex = (m_nextRefittedTreeIndex + numOfRefittedTrees) % numOfTrees;
+    }
+
+    void RandomForestRegressor::SetRandomSeed(std::uint64_t seed) {
+        m_randomSeed = seed;
+        for (int treeIndex = 0; treeIndex < std::ssize(m_trees); ++treeIndex)
+            m_trees[treeIndex].SetRandomSeed(RandomGenerators::PhiloxRandom::GetChildStream(seed, treeIndex));
+    }
+
+    std::unique_ptr<RegressionModel> RandomForestRegressor::CreateUnfittedCopy() const {
+        const auto& tree = m_trees.front();
+        auto copy = std::make_unique<RandomForestRegressor>(std::ssize(m_trees), c_proportionOfRowsUsed, tree.c_maxDepth, tree.c_minSampleSize,
+                                                            tree.c_proportionOfFeaturesUsed, tree.c_splittingMode, tree.c_maxNumOfBins);
+        copy->SetRandomSeed(m_randomSeed);
+        return copy;
+    }
+
+    void RandomForestRegressor::SaveToFile(const std::string& fileName) const {
+        if (m_numOfPredictedValues == 0)
+            throw std::logic_error("Model is not fitted");
+
+        std::vector<const DecisionTrees::FlatDecisionTree*> trees;
+        for (const auto& tree : m_trees)
+            trees.push_back(&tree.GetFlatTree());
+
+        auto parameters = m_trees.front().GetSerializedParameters();
+        parameters.push_back(c_proportionOfRowsUsed);
+        ModelSerializationUtils::SaveModelToFile(fileName, ModelSerializationUtils::ModelType::RandomForest, m_numOfPredictedValues, parameters, trees);
+    }
+
+    RandomForestRegressor RandomForestRegressor::LoadFromFile(const std::string& fileName) {
+        auto modelFile = ModelSerializationUtils::LoadModelFromFile(fileName, ModelSerializationUtils::ModelType::RandomForest);
+        if (modelFile.Trees.empty() || modelFile.Parameters.empty())
+            throw std::invalid_argument("Invalid random forest model file");
+
+        const double proportionOfRowsUsed = modelFile.Parameters.back();
+        const auto treeParameters = std::span(modelFile.Parameters).first(modelFile.Parameters.size() - 1);
+        const auto tree = DecisionTrees::DecisionTreeRegressor::CreateFromSerializedParameters(treeParameters);
+
+        RandomForestRegressor forest(std::ssize(modelFile.Trees), proportionOfRowsUsed, tree.c_maxDepth, tree.c_minSampleSize,
+                                     tree.c_proportionOfFeaturesUsed, tree.c_splittingMode, tree.c_maxNumOfBins);
+        forest.m_numOfPredictedValues = modelFile.NumOfPredictedValues;
+        for (int treeIndex = 0; treeIndex < std::ssize(modelFile.Trees); ++treeIndex)
+            forest.m_trees[treeIndex].m_flatTree = std::move(modelFile.Trees[treeIndex]);
+
+        return forest;
     }
 
     std::vector<double> RandomForestRegressor::Predict(const std::vector<double>& features) const {
@@ -34,7 +107,7 @@ namespace MachineLearning::Ensembles {
         const auto numOfTrees = static_cast<double>(m_trees.size());
 
         for (const auto& tree : m_trees) {
-            const auto predictedValues = tree.Predict(features);
+            const auto predictedValues = tree.GetFlatTree().Predict(features);
             std::ranges::transform(res, predictedValues, res.begin(), [numOfTrees](double res, double val){ return res + val / numOfTrees; });
         }
 
@@ -42,28 +115,35 @@ namespace MachineLearning::Ensembles {
     }
 
     DataContainers::Table<double> RandomForestRegressor::Predict(const DataContainers::TableView<double>& features) const {
-        DataContainers::Table<double> res;
-        res.SetNumOfColumns(m_numOfPredictedValues);
-
-        for (int rowIndex = 0; rowIndex < features.GetNumOfRows(); ++rowIndex)
-            res.PushBackRow(Predict(features.GetRow(rowIndex) | RangesUtils::to_vector));
-
-        return res;
+        return BatchPredictionUtils::PredictByRowBlocks(features, m_numOfPredictedValues,
+            [this](const BatchPredictionUtils::FeaturesBlock& featuresBlock, std::span<double> predictions) {
+                const auto numOfTrees = static_cast<double>(m_trees.size());
+                std::array<int, BatchPredictionUtils::RowBlockSize> leafNodeIndexes{};
+
+                for (const auto& tree : m_trees) {
+                    const auto& flatTree = tree.GetFlatTree();
+                    flatTree.FindLeafNodes(featuresBlock.Values, featuresBlock.NumOfRows, leafNodeIndexes);
+
+                    for (int rowIndex = 0; rowIndex < featuresBlock.NumOfRows; ++rowIndex) {
+                        const auto rowPredictions = predictions.subspan(rowIndex * m_numOfPredictedValues, m_numOfPredictedValues);
+                        std::ranges::transform(rowPredictions, flatTree.GetLeafValues(leafNodeIndexes[rowIndex]), rowPredictions.begin(),
+                                               [numOfTrees](double res, double val){ return res + val / numOfTrees; });
+                    }
+                }
+            });
     }
 
-    Datasets::SupervisedLearningDatasetView<double> RandomForestRegressor::CreateBootstrappedDataset(
-        const Datasets::SupervisedLearningDatasetView<double> &originalDataset) const {
-        const auto& [originalFeatures, originalObservations] = originalDataset;
-        Datasets::SupervisedLearningDatasetView bootstrappedDataset(originalFeatures.GetViewableTable(), originalObservations.GetViewableTable());
+    std::vector<double> RandomForestRegressor::CreateBootstrapCounts(int numOfRows, int treeIndex) const {
+        std::vector<double> bootstrapCounts(numOfRows, 0.0);
 
-        std::uniform_int_distribution distribution(0, originalFeatures.GetNumOfRows() - 1);
-        const auto numOfBootstrappedRows = std::max(1, static_cast<int>((double)originalFeatures.GetNumOfRows() * c_proportionOfRowsUsed));
+        std::uniform_int_distribution distribution(0, numOfRows - 1);
+        const auto numOfBootstrappedRows = std::max(1, static_cast<int>((double)numOfRows * c_proportionOfRowsUsed));
+        // A tree refitted on more rows gets a fresh bootstrap
+        RandomGenerators::PhiloxRandom generator(m_randomSeed, RandomGenerators::PhiloxRandom::GetChildStream(treeIndex, numOfRows));
 
-        for (int i = 0; i < numOfBootstrappedRows; ++i) {
-            const auto rowIndex = distribution(RandomGenerators::ThreadSafeRandom::Generator);
-            bootstrappedDataset.PushBackViewableRowIndex(originalFeatures.GetViewableTableRowIndex(rowIndex));
-        }
+        for (int i = 0; i < numOfBootstrappedRows; ++i)
+            ++bootstrapCounts[distribution(generator)];
 
-        return bootstrappedDataset;
+        return bootstrapCounts;
     }
 }
@@ -2,6 +2,7 @@
 #define RANDOMFORESTREGRESSOR_H
 
 #include <vector>
+#include <string>
 #include <MachineLearning/RegressionModel.h>
 #include <MachineLearning/DecisionTrees/DecisionTreeRegressor.h>
 
@@ -13,22 +14,42 @@ namespace MachineLearning::Ensembles {
             double proportionOfRowsUsed = 1.0,
             int maxDepth = 5,
             int minSampleSize = 20,
-            double proportionOfFeaturesUsed = 1.0
+            double proportionOfFeaturesUsed = 1.0,
+            DecisionTrees::SplittingMode splittingMode = DecisionTrees::SplittingMode::Exact,
+            int maxNumOfBins = 255
         );
 
+        RandomForestRegressor(RandomForestRegressor&& other) noexcept = default;
         ~RandomForestRegressor() override = default;
 
         void Fit(const Datasets::SupervisedLearningDatasetView<double>& dataset) override;
+        /// Refits on fresh bootstraps only as many trees as the proportion of appended rows, the longest kept ones first.
+        /// The other trees keep their fit on fewer rows, so the forest only approximates the one Fit grows
+        void FitIncrementally(const Datasets::SupervisedLearningDatasetView<double>& dataset) override;
 
         [[nodiscard]] std::vector<double> Predict(const std::vector<double>& features) const override;
         [[nodiscard]] DataContainers::Table<double> Predict(const DataContainers::TableView<double>& features) const override;
 
+        /// Trees are seeded with streams of the seed, the bootstrap of every tree draws from its own stream
+        void SetRandomSeed(std::uint64_t seed) override;
+        [[nodiscard]] std::unique_ptr<RegressionModel> CreateUnfittedCopy() const override;
+
+        [[nodiscard]] const std::vector<DecisionTrees::DecisionTreeRegressor>& GetTrees() const { return m_trees; }
+
+        void SaveToFile(const std::string& fileName) const;
+        /// Loaded trees read their nodes straight from the mapped file
+        [[nodiscard]] static RandomForestRegressor LoadFromFile(const std::string& fileName);
+
     private:
-        [[nodiscard]] Datasets::SupervisedLearningDatasetView<double> CreateBootstrappedDataset(const Datasets::SupervisedLearningDatasetView<double>& originalDataset) const;
+        /// Number of times every row is drawn into the bootstrap of the tree
+        [[nodiscard]] std::vector<double> CreateBootstrapCounts(int numOfRows, int treeIndex) const;
 
     private:
         const double c_proportionOfRowsUsed;
         int m_numOfPredictedValues;
+        int m_numOfFittedRows = 0;
+        int m_nextRefittedTreeIndex = 0;
+        std::uint64_t m_randomSeed = 0;
         std::vector<DecisionTrees::DecisionTreeRegressor> m_trees;
     };
 }
@@ -2,16 +2,28 @@
 #define DECISION_TREE_2_REGRESSIONMODEL_H
 
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <MachineLearning/Datasets/SupervisedLearningDatasetView.h>
 
 namespace MachineLearning {
     class RegressionModel {
     public:
         virtual void Fit(const Datasets::SupervisedLearningDatasetView<double>& dataset) = 0;
+        /// Refits on the dataset of the previous fit with rows appended at its end, reusing what that fit computed.
+        /// Fits from scratch unless a model knows better. Ensembles may keep part of the previous fit, approximating Fit rather than repeating it
+        virtual void FitIncrementally(const Datasets::SupervisedLearningDatasetView<double>& dataset) { Fit(dataset); }
 
        [[nodiscard]] virtual std::vector<double> Predict(const std::vector<double>& features) const = 0;
        [[nodiscard]] virtual DataContainers::Table<double> Predict(const DataContainers::TableView<double>& features) const = 0;
 
+        /// Makes the following fits draw every random number from streams of the seed, so they are reproducible at any number of threads.
+        /// Models that draw no random numbers ignore it
+        virtual void SetRandomSeed(std::uint64_t seed) {}
+
+        /// Model with the same hyperparameters and seed that is yet to be fitted
+        [[nodiscard]] virtual std::unique_ptr<RegressionModel> CreateUnfittedCopy() const = 0;
+
         virtual ~RegressionModel() = 0;
     };
 }
@@ -0,0 +1,15 @@
+#include "BatchPredictionUtils.h"
+
+namespace MachineLearning::BatchPredictionUtils {
+    void GatherFeaturesBlock(const DataContainers::TableView<double>& features, int firstRowIndex, int numOfRows, FeaturesBlock& featuresBlock) {
+        featuresBlock.NumOfRows = numOfRows;
+        featuresBlock.NumOfColumns = features.GetNumOfColumns();
+        featuresBlock.Values.resize(numOfRows * featuresBlock.NumOfColumns);
+
+        for (int columnIndex = 0; columnIndex < featuresBlock.NumOfColumns; ++columnIndex) {
+            const auto column = features.GetViewableTableColumnSpan(columnIndex);
+            for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+                featuresBlock.Values[columnIndex * numOfRows + rowIndex] = column[features.GetViewableTableRowIndex(firstRowIndex + rowIndex)];
+        }
+    }
+}
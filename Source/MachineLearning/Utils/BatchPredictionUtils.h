@@ -0,0 +1,64 @@
+#ifndef DECISION_TREE_2_BATCHPREDICTIONUTILS_H
+#define DECISION_TREE_2_BATCHPREDICTIONUTILS_H
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <concepts>
+#include <DataContainers/Table.h>
+#include <DataContainers/TableView.h>
+
+namespace MachineLearning::BatchPredictionUtils {
+    constexpr int RowBlockSize = 256;
+
+    struct FeaturesBlock {
+        int NumOfRows = 0;
+        int NumOfColumns = 0;
+        std::vector<double> Values;     ///< Column-major block values, column stride is NumOfRows
+    };
+
+    void GatherFeaturesBlock(const DataContainers::TableView<double>& features, int firstRowIndex, int numOfRows, FeaturesBlock& featuresBlock);
+
+    template<class BlockPredictor>
+    requires std::invocable<BlockPredictor&, const FeaturesBlock&, std::span<double>>
+    [[nodiscard]] DataContainers::Table<double> PredictByRowBlocks(
+        const DataContainers::TableView<double>& features,
+        int numOfPredictedValues,
+        BlockPredictor predictBlock)
+    {
+        DataContainers::Table<double> res(features.GetNumOfRows(), numOfPredictedValues);
+        // Models yet to be fitted predict no values and have no leaves to look up
+        if (numOfPredictedValues == 0)
+            return res;
+
+        const int numOfBlocks = (features.GetNumOfRows() + RowBlockSize - 1) / RowBlockSize;
+
+        #pragma omp parallel
+        {
+            // Every thread calls its own copy, so predictors may keep reusable buffers in their captures
+            BlockPredictor threadPredictBlock = predictBlock;
+            FeaturesBlock featuresBlock;
+            std::vector<double> predictionsBlock;
+
+            #pragma omp for schedule(dynamic)
+            for (int blockIndex = 0; blockIndex < numOfBlocks; ++blockIndex) {
+                const int firstRowIndex = blockIndex * RowBlockSize;
+                const int numOfRows = std::min(RowBlockSize, features.GetNumOfRows() - firstRowIndex);
+
+                GatherFeaturesBlock(features, firstRowIndex, numOfRows, featuresBlock);
+                predictionsBlock.assign(numOfRows * numOfPredictedValues, 0.0);
+                threadPredictBlock(featuresBlock, std::span(predictionsBlock));
+
+                for (int columnIndex = 0; columnIndex < numOfPredictedValues; ++columnIndex) {
+                    const auto column = res.GetColumnSpan(columnIndex).subspan(firstRowIndex, numOfRows);
+                    for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)
+                        column[rowIndex] = predictionsBlock[rowIndex * numOfPredictedValues + columnIndex];
+                }
+            }
+        }
+
+        return res;
+    }
+}
+
+#endif
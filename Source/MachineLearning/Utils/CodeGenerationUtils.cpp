@@ -0,0 +1,210 @@
+#include "CodeGenerationUtils.h"
+#include <algorithm>
+
+namespace MachineLearning::CodeGenerationUtils {
+    namespace {
+        using DecisionTrees::FlatDecisionTree;
+
+        int GetNumOfUsedFeatures(std::span<const FlatDecisionTree* const> trees) {
+            int numOfFeatures = 0;
+            for (const auto* tree : trees)
+                for (int nodeIndex = 0; nodeIndex < tree->GetNumOfNodes(); ++nodeIndex)
+                    numOfFeatures = std::max(numOfFeatures, tree->GetFeatureIndex(nodeIndex) + 1);
+
+            return numOfFeatures;
+        }
+
+        void EmitIndent(std::ostream& out, int depth) {
+            for (int i = 0; i < depth; ++i)
+                out << "    ";
+        }
+
+        void EmitTreeNode(std::ostream& out, const FlatDecisionTree& tree, int treeIndex, int nodeIndex, int depth) {
+            EmitIndent(out, depth);
+            if (tree.IsLeaf(nodeIndex)) {
+                out << "return Tree" << treeIndex << "Leaves + " << tree.GetLeftChildIndex(nodeIndex) * tree.GetNumOfPredictedValues() << ";\n";
+                return;
+            }
+
+            out << "if (x[" << tree.GetFeatureIndex(nodeIndex) << " * stride] > " << tree.GetThreshold(nodeIndex) << ") {\n";
+            EmitTreeNode(out, tree, treeIndex, tree.GetRightChildIndex(nodeIndex), depth + 1);
+            EmitIndent(out, depth);
+            out << "}\n";
+            EmitTreeNode(out, tree, treeIndex, tree.GetLeftChildIndex(nodeIndex), depth);
+        }
+
+        void EmitTree(std::ostream& out, const FlatDecisionTree& tree, int treeIndex, double leafValuesScale) {
+            out << "    constexpr double Tree" << treeIndex << "Leaves[] = {";
+            for (int nodeIndex = 0; nodeIndex < tree.GetNumOfNodes(); ++nodeIndex) {
+                if (!tree.IsLeaf(nodeIndex))
+                    continue;
+
+                for (auto value : tree.GetLeafValues(nodeIndex))
+                    out << value / leafValuesScale << ", ";
+            }
+            out << "};\n\n";
+
+            out << "    inline const double* Tree" << treeIndex << "(const double* x, std::ptrdiff_t stride) {\n";
+            EmitTreeNode(out, tree, treeIndex, 0, 2);
+            out << "    }\n\n";
+        }
+
+        void EmitHeader(std::ostream& out, std::span<const FlatDecisionTree* const> trees) {
+            out << std::hexfloat;
+            out << "// Generated by MachineLearning::CodeGenerationUtils, do not edit\n"
+                << "#include <algorithm>\n"
+                << "#include <array>\n"
+                << "#include <cstddef>\n"
+                << "#include <utility>\n\n"
+                << "namespace {\n"
+                << "    constexpr int NumOfFeatures = " << GetNumOfUsedFeatures(trees) << ";\n"
+                << "    constexpr int NumOfPredictedValues = " << trees.front()->GetNumOfPredictedValues() << ";\n"
+                << "    constexpr int NumOfTrees = " << trees.size() << ";\n\n";
+        }
+
+        void EmitFooter(std::ostream& out) {
+            out << "}\n\n"
+                << "extern \"C\" {\n"
+                << "    int " << CompiledModelSymbols::NumOfFeatures << "() { return NumOfFeatures; }\n"
+                << "    int " << CompiledModelSymbols::NumOfPredictedValues << "() { return NumOfPredictedValues; }\n\n"
+                << "    void " << CompiledModelSymbols::Predict << "(const double* features, double* predictions) {\n"
+                << "        PredictRow(features, 1, predictions);\n"
+                << "    }\n\n"
+                << "    void " << CompiledModelSymbols::PredictBlock << "(const double* columnMajorFeatures, int numOfRows, double* predictions) {\n"
+                << "        for (int rowIndex = 0; rowIndex < numOfRows; ++rowIndex)\n"
+                << "            PredictRow(columnMajorFeatures + rowIndex, numOfRows, predictions + rowIndex * NumOfPredictedValues);\n"
+                << "    }\n"
+                << "}\n";
+            out << std::defaultfloat;
+        }
+
+        std::vector<const FlatDecisionTree*> GetFlatTrees(const std::vector<DecisionTrees::DecisionTreeRegressor>& trees) {
+            std::vector<const FlatDecisionTree*> flatTrees;
+            for (const auto& tree : trees)
+                flatTrees.push_back(&tree.GetFlatTree());
+
+            if (flatTrees.empty() || flatTrees.front()->GetNumOfNodes() == 0)
+                throw std::invalid_argument("Model is not fitted");
+
+            return flatTrees;
+        }
+
+        std::vector<FlatDecisionTree> GetFlatTrees(const std::vector<DecisionTrees::DecisionStumpRegressor>& stumps) {
+            if (stumps.empty())
+                throw std::invalid_argument("Model is not fitted");
+
+            std::vector<FlatDecisionTree> flatTrees;
+            flatTrees.reserve(stumps.size());
+            for (const auto& stump : stumps)
+                flatTrees.push_back(stump.ToFlatTree());
+
+            return flatTrees;
+        }
+    }
+
+    void GenerateModelSource(const DecisionTrees::DecisionTreeRegressor& model, std::ostream& out) {
+        const std::vector<const FlatDecisionTree*> trees{&model.GetFlatTree()};
+        if (trees.front()->GetNumOfNodes() == 0)
+            throw std::invalid_argument("Model is not fitted");
+
+        EmitHeader(out, trees);
+        EmitTree(out, *trees.front(), 0, 1.0);
+        out << "    inline void PredictRow(const double* x, std::ptrdiff_t stride, double* predictions) {\n"
+            << "        std::copy_n(Tree0(x, stride), NumOfPredictedValues, predictions);\n"
+            << "    }\n";
+        EmitFooter(out);
+    }
+
+    void GenerateModelSource(const Ensembles::RandomForestRegressor& model, std::ostream& out) {
+        const auto trees = GetFlatTrees(model.GetTrees());
+        const auto numOfTrees = static_cast<double>(trees.size());
+
+        EmitHeader(out, trees);
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex)
+            EmitTree(out, *trees[treeIndex], treeIndex, numOfTrees);
+
+        out << "    inline void PredictRow(const double* x, std::ptrdiff_t stride, double* predictions) {\n"
+            << "        std::fill_n(predictions, NumOfPredictedValues, 0.0);\n"
+            << "        const double* leafValues;\n";
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex)
+            out << "        leafValues = Tree" << treeIndex << "(x, stride);\n"
+                << "        for (int i = 0; i < NumOfPredictedValues; ++i) predictions[i] += leafValues[i];\n";
+        out << "    }\n";
+        EmitFooter(out);
+    }
+
+    void GenerateModelSource(const Ensembles::AdaBoostRegressor& model, std::ostream& out) {
+        const auto flatTrees = GetFlatTrees(model.GetTrees());
+        std::vector<const FlatDecisionTree*> trees;
+        for (const auto& flatTree : flatTrees)
+            trees.push_back(&flatTree);
+
+        EmitHeader(out, trees);
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex)
+            EmitTree(out, *trees[treeIndex], treeIndex, 1.0);
+
+        out << "    constexpr double TotalTreesWeight = " << model.GetTotalTreesWeight() << ";\n"
+            << "    constexpr double TreeWeights[] = {";
+        for (auto weight : model.GetTreeWeights())
+            out << weight << ", ";
+        out << "};\n\n";
+
+        out << "    inline void PredictRow(const double* x, std::ptrdiff_t stride, double* predictions) {\n"
+            << "        const std::array<const double*, NumOfTrees> treePredictions{\n";
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex)
+            out << "            Tree" << treeIndex << "(x, stride),\n";
+        out << "        };\n\n"
+            << "        // Same selection as AdaBoostRegressor::FindWeightedMedianTree, trees ranked by prediction length and index\n"
+            << "        std::array<std::pair<double, int>, NumOfTrees> candidates{};\n"
+            << "        for (int i = 0; i < NumOfTrees; ++i) {\n"
+            << "            double lengthSquared = 0.0;\n"
+            << "            for (int j = 0; j < NumOfPredictedValues; ++j)\n"
+            << "                lengthSquared += treePredictions[i][j] * treePredictions[i][j];\n"
+            << "            candidates[i] = {lengthSquared, i};\n"
+            << "        }\n\n"
+            << "        auto first = candidates.begin();\n"
+            << "        auto last = candidates.end();\n"
+            << "        double weightAfterLast = 0.0;\n"
+            << "        while (last - first > 1) {\n"
+            << "            const auto middle = first + (last - first - 1) / 2;\n"
+            << "            std::nth_element(first, middle, last);\n\n"
+            << "            double weightAfterMiddle = weightAfterLast;\n"
+            << "            for (auto candidate = middle + 1; candidate != last; ++candidate)\n"
+            << "                weightAfterMiddle += TreeWeights[candidate->second];\n\n"
+            << "            if (weightAfterMiddle <= TotalTreesWeight / 2.) {\n"
+            << "                last = middle + 1;\n"
+            << "                weightAfterLast = weightAfterMiddle;\n"
+            << "            }\n"
+            << "            else {\n"
+            << "                first = middle + 1;\n"
+            << "            }\n"
+            << "        }\n\n"
+            << "        std::copy_n(treePredictions[first->second], NumOfPredictedValues, predictions);\n"
+            << "    }\n";
+        EmitFooter(out);
+    }
+
+    void GenerateModelSource(const Ensembles::GradientBoostingRegressor& model, std::ostream& out) {
+        const auto trees = GetFlatTrees(model.GetTrees());
+
+        EmitHeader(out, trees);
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex)
+            EmitTree(out, *trees[treeIndex], treeIndex, 1.0);
+
+        out << "    constexpr double LearningRate = " << model.GetLearningRate() << ";\n"
+            << "    constexpr double InitialPredictions[] = {";
+        for (auto value : model.GetInitialPredictions())
+            out << value << ", ";
+        out << "};\n\n";
+
+        // Leaves are shrunk at prediction time as by GradientBoostingRegressor::Predict, so the sums round the same
+        out << "    inline void PredictRow(const double* x, std::ptrdiff_t stride, double* predictions) {\n"
+            << "        std::copy_n(InitialPredictions, NumOfPredictedValues, predictions);\n"
+            << "        const double* leafValues;\n";
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex)
+            out << "        leafValues = Tree" << treeIndex << "(x, stride);\n"
+                << "        for (int i = 0; i < NumOfPredictedValues; ++i) predictions[i] += LearningRate * leafValues[i];\n";
+        out << "    }\n";
+        EmitFooter(out);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef DECISION_TREE_2_CODEGENERATIONUTILS_H
+#define DECISION_TREE_2_CODEGENERATIONUTILS_H
+
+#include <ostream>
+#include <fstream>
+#include <string>
+#include <MachineLearning/DecisionTrees/DecisionTreeRegressor.h>
+#include <MachineLearning/Ensembles/RandomForestRegressor.h>
+#include <MachineLearning/Ensembles/AdaBoostRegressor.h>
+#include <MachineLearning/Ensembles/GradientBoostingRegressor.h>
+
+namespace MachineLearning::CodeGenerationUtils {
+    namespace CompiledModelSymbols {
+        constexpr auto NumOfFeatures = "DecisionTree2NumOfFeatures";
+        constexpr auto NumOfPredictedValues = "DecisionTree2NumOfPredictedValues";
+        constexpr auto Predict = "DecisionTree2Predict";
+        constexpr auto PredictBlock = "DecisionTree2PredictBlock";
+    }
+
+    void GenerateModelSource(const DecisionTrees::DecisionTreeRegressor& model, std::ostream& out);
+    void GenerateModelSource(const Ensembles::RandomForestRegressor& model, std::ostream& out);
+    void GenerateModelSource(const Ensembles::AdaBoostRegressor& model, std::ostream& out);
+    void GenerateModelSource(const Ensembles::GradientBoostingRegressor& model, std::ostream& out);
+
+    template<class ModelType>
+    void GenerateModelSourceFile(const ModelType& model, const std::string& fileName) {
+        std::ofstream out(fileName);
+        if (!out.is_open())
+            throw std::invalid_argument("Failed to open file");
+
+        GenerateModelSource(model, out);
+    }
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include "ModelSerializationUtils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <DataContainers/Utils/MappedFile.h>
+
+namespace MachineLearning::ModelSerializationUtils {
+    namespace {
+        using DecisionTrees::FlatDecisionTree;
+
+        constexpr std::string_view ModelMagic = "DT2MODEL";
+        constexpr std::uint64_t ArrayAlignment = 64;
+
+        struct FileHeader {
+            char Magic[8];
+            std::uint32_t Version;
+            std::uint32_t Type;
+            std::uint32_t NumOfPredictedValues;
+            std::uint32_t NumOfParameters;
+            std::uint32_t NumOfTrees;
+            std::uint32_t NumOfTreeWeights;
+        };
+
+        struct TreeHeader {
+            std::uint64_t FirstNodeIndex;
+            std::uint64_t NumOfNodes;
+            std::uint64_t FirstLeafValueIndex;
+            std::uint64_t NumOfLeafValues;
+        };
+
+        struct ModelFileLayout {
+            std::uint64_t ParametersOffset = 0;
+            std::uint64_t TreeWeightsOffset = 0;
+            std::uint64_t TreeHeadersOffset = 0;
+            std::uint64_t FeatureIndexesOffset = 0;
+            std::uint64_t ThresholdsOffset = 0;
+            std::uint64_t ChildOffsetsOffset = 0;
+            std::uint64_t LeafValuesOffset = 0;
+            std::uint64_t FileSize = 0;
+        };
+
+        std::uint64_t AlignModelArray(std::uint64_t offset) {
+            return (offset + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+        }
+
+        ModelFileLayout GetModelFileLayout(const FileHeader& header, std::uint64_t numOfNodes, std::uint64_t numOfLeafValues) {
+            ModelFileLayout layout;
+            layout.ParametersOffset = sizeof(FileHeader);
+            layout.TreeWeightsOffset = layout.ParametersOffset + header.NumOfParameters * sizeof(double);
+            layout.TreeHeadersOffset = layout.TreeWeightsOffset + header.NumOfTreeWeights * sizeof(double);
+            layout.FeatureIndexesOffset = AlignModelArray(layout.TreeHeadersOffset + header.NumOfTrees * sizeof(TreeHeader));
+            layout.ThresholdsOffset = AlignModelArray(layout.FeatureIndexesOffset + numOfNodes * sizeof(int));
+            layout.ChildOffsetsOffset = AlignModelArray(layout.ThresholdsOffset + numOfNodes * sizeof(double));
+            layout.LeafValuesOffset = AlignModelArray(layout.ChildOffsetsOffset + numOfNodes * sizeof(int));
+            layout.FileSize = layout.LeafValuesOffset + numOfLeafValues * sizeof(double);
+            return layout;
+        }
+
+        template<class T>
+        void WriteModelArray(std::ofstream& out, std::uint64_t offset, std::span<const T> values) {
+            out.seekp(static_cast<std::streamoff>(offset));
+            out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+        }
+
+        template<class T>
+        std::span<const T> GetMappedModelArray(const DataContainers::MappedFile& file, std::uint64_t offset, std::uint64_t size) {
+            return {reinterpret_cast<const T*>(file.GetData() + offset), size};
+        }
+    }
+
+    void SaveModelToFile(
+        const std::string& fileName,
+        ModelType type,
+        int numOfPredictedValues,
+        std::span<const double> parameters,
+        std::span<const FlatDecisionTree* const> trees,
+        std::span<const double> treeWeights)
+    {
+        if (!treeWeights.empty() && treeWeights.size() != trees.size())
+            throw std::invalid_argument("Number of tree weights is not equal to number of trees");
+
+        FileHeader header{{}, FormatVersion, static_cast<std::uint32_t>(type), static_cast<std::uint32_t>(numOfPredictedValues),
+                          static_cast<std::uint32_t>(parameters.size()), static_cast<std::uint32_t>(trees.size()), static_cast<std::uint32_t>(treeWeights.size())};
+        std::ranges::copy(ModelMagic, header.Magic);
+
+        std::vector<TreeHeader> treeHeaders;
+        std::uint64_t numOfNodes = 0;
+        std::uint64_t numOfLeafValues = 0;
+        for (const auto* tree : trees) {
+            if (tree->GetNumOfPredictedValues() != numOfPredictedValues)
+                throw std::invalid_argument("Tree predicts another number of values than the model");
+
+            treeHeaders.push_back({numOfNodes, static_cast<std::uint64_t>(tree->GetNumOfNodes()), numOfLeafValues, tree->GetAllLeafValues().size()});
+            numOfNodes += tree->GetNumOfNodes();
+            numOfLeafValues += tree->GetAllLeafValues().size();
+        }
+
+        const auto layout = GetModelFileLayout(header, numOfNodes, numOfLeafValues);
+
+        std::ofstream out(fileName, std::ios::binary);
+        if (!out.is_open())
+            throw std::invalid_argument("Failed to open file");
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteModelArray(out, layout.ParametersOffset, parameters);
+        WriteModelArray(out, layout.TreeWeightsOffset, treeWeights);
+        WriteModelArray(out, layout.TreeHeadersOffset, std::span<const TreeHeader>(treeHeaders));
+        for (int treeIndex = 0; treeIndex < std::ssize(trees); ++treeIndex) {
+            const auto& treeHeader = treeHeaders[treeIndex];
+            WriteModelArray(out, layout.FeatureIndexesOffset + treeHeader.FirstNodeIndex * sizeof(int), trees[treeIndex]->GetFeatureIndexes());
+            WriteModelArray(out, layout.ThresholdsOffset + treeHeader.FirstNodeIndex * sizeof(double), trees[treeIndex]->GetThresholds());
+            WriteModelArray(out, layout.ChildOffsetsOffset + treeHeader.FirstNodeIndex * sizeof(int), trees[treeIndex]->GetChildOffsets());
+            WriteModelArray(out, layout.LeafValuesOffset + treeHeader.FirstLeafValueIndex * sizeof(double), trees[treeIndex]->GetAllLeafValues());
+        }
+
+        if (!out)
+            throw std::runtime_error("Failed to write model file");
+    }
+
+    ModelFile LoadModelFromFile(const std::string& fileName, ModelType expectedType) {
+        const auto file = std::make_shared<const DataContainers::MappedFile>(fileName);
+
+        FileHeader header{};
+        if (file->GetSize() < sizeof(header))
+            throw std::invalid_argument("File is not a model file");
+
+        std::memcpy(&header, file->GetData(), sizeof(header));
+        if (std::string_view(header.Magic, sizeof(header.Magic)) != ModelMagic)
+            throw std::invalid_argument("File is not a model file");
+
+        if (header.Version != FormatVersion)
+            throw std::invalid_argument("Unsupported model file version");
+
+        if (static_cast<ModelType>(header.Type) != expectedType)
+            throw std::invalid_argument("Model file contains another type of model");
+
+        if (header.NumOfTreeWeights != 0 && header.NumOfTreeWeights != header.NumOfTrees)
+            throw std::invalid_argument("Number of tree weights is not equal to number of trees");
+
+        const auto headersLayout = GetModelFileLayout(header, 0, 0);
+        if (headersLayout.FeatureIndexesOffset > file->GetSize())
+            throw std::invalid_argument("Model file is truncated");
+
+        const auto treeHeaders = GetMappedModelArray<TreeHeader>(*file, headersLayout.TreeHeadersOffset, header.NumOfTrees);
+        std::uint64_t numOfNodes = 0;
+        std::uint64_t numOfLeafValues = 0;
+        for (const auto& treeHeader : treeHeaders) {
+            if (treeHeader.FirstNodeIndex != numOfNodes || treeHeader.FirstLeafValueIndex != numOfLeafValues || treeHeader.NumOfNodes > file->GetSize())
+                throw std::invalid_argument("Invalid tree layout in model file");
+
+            numOfNodes += treeHeader.NumOfNodes;
+            numOfLeafValues += treeHeader.NumOfLeafValues;
+            if (numOfLeafValues > file->GetSize())
+                throw std::invalid_argument("Invalid tree layout in model file");
+        }
+
+        const auto layout = GetModelFileLayout(header, numOfNodes, numOfLeafValues);
+        if (layout.FileSize > file->GetSize())
+            throw std::invalid_argument("Model file is truncated");
+
+        ModelFile modelFile{expectedType, static_cast<int>(header.NumOfPredictedValues), {}, {}, {}};
+        std::ranges::copy(GetMappedModelArray<double>(*file, layout.ParametersOffset, header.NumOfParameters), std::back_inserter(modelFile.Parameters));
+        std::ranges::copy(GetMappedModelArray<double>(*file, layout.TreeWeightsOffset, header.NumOfTreeWeights), std::back_inserter(modelFile.TreeWeights));
+
+        const auto featureIndexes = GetMappedModelArray<int>(*file, layout.FeatureIndexesOffset, numOfNodes);
+        const auto thresholds = GetMappedModelArray<double>(*file, layout.ThresholdsOffset, numOfNodes);
+        const auto childOffsets = GetMappedModelArray<int>(*file, layout.ChildOffsetsOffset, numOfNodes);
+        const auto leafValues = GetMappedModelArray<double>(*file, layout.LeafValuesOffset, numOfLeafValues);
+
+        modelFile.Trees.reserve(treeHeaders.size());
+        for (const auto& treeHeader : treeHeaders) {
+            modelFile.Trees.emplace_back(file, modelFile.NumOfPredictedValues,
+                                         featureIndexes.subspan(treeHeader.FirstNodeIndex, treeHeader.NumOfNodes),
+                                         thresholds.subspan(treeHeader.FirstNodeIndex, treeHeader.NumOfNodes),
+                                         childOffsets.subspan(treeHeader.FirstNodeIndex, treeHeader.NumOfNodes),
+                                         leafValues.subspan(treeHeader.FirstLeafValueIndex, treeHeader.NumOfLeafValues));
+        }
+
+        return modelFile;
+    }
+}
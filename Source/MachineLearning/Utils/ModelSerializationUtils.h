@@ -0,0 +1,41 @@
+#ifndef DECISION_TREE_2_MODELSERIALIZATIONUTILS_H
+#define DECISION_TREE_2_MODELSERIALIZATIONUTILS_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <MachineLearning/DecisionTrees/FlatDecisionTree.h>
+
+/// Versioned binary model file in native byte order: header, model parameters, tree weights, tree headers,
+/// then the node arrays of all trees concatenated and 64-byte aligned, so that loaded trees read straight from the mapping
+namespace MachineLearning::ModelSerializationUtils {
+    constexpr std::uint32_t FormatVersion = 1;
+
+    enum class ModelType : std::uint32_t {
+        DecisionTree = 1,
+        RandomForest = 2,
+        AdaBoost = 3,
+        GradientBoosting = 4
+    };
+
+    struct ModelFile {
+        ModelType Type = ModelType::DecisionTree;
+        int NumOfPredictedValues = 0;
+        std::vector<double> Parameters;                     ///< Model specific hyperparameters
+        std::vector<double> TreeWeights;                    ///< Empty if the model does not weight its trees
+        std::vector<DecisionTrees::FlatDecisionTree> Trees; ///< Trees reading from the mapped file
+    };
+
+    void SaveModelToFile(
+        const std::string& fileName,
+        ModelType type,
+        int numOfPredictedValues,
+        std::span<const double> parameters,
+        std::span<const DecisionTrees::FlatDecisionTree* const> trees,
+        std::span<const double> treeWeights = {});
+
+    [[nodiscard]] ModelFile LoadModelFromFile(const std::string& fileName, ModelType expectedType);
+}
+
+#endif
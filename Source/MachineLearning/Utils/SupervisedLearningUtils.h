@@ -2,6 +2,7 @@
 #define DECISION_TREE_2_SUPERVISEDLEARNINGUTILS_H
 
 #include <MachineLearning/Datasets/SupervisedLearningDatasetView.h>
+#include <DataContainers/Utils/BinaryTableUtils.h>
 
 namespace MachineLearning::SupervisedLearningUtils {
     template<class StoredType>
@@ -12,22 +13,51 @@ namespace MachineLearning::SupervisedLearningUtils {
 
     template<class StoredType>
     TrainingAndTestDatasets<StoredType>
-    SplitDatasetIntoTestAndTraining(const Datasets::SupervisedLearningDataset<StoredType>& dataset, double proportionOfTrainingData) {
+    SplitDatasetIntoTestAndTraining(const Datasets::SupervisedLearningDatasetView<StoredType>& dataset, double proportionOfTrainingData) {
         if (proportionOfTrainingData <= 0 || proportionOfTrainingData > 1.0)
             throw std::invalid_argument("Invalid proportion of training data");
 
-        Datasets::SupervisedLearningDatasetView<StoredType> trainingDataset(dataset);
-        Datasets::SupervisedLearningDatasetView<StoredType> testDataset(dataset);
+        const auto& [features, observations] = dataset;
+        Datasets::SupervisedLearningDatasetView<StoredType> trainingDataset(features.CopyWithoutViewableRows(), observations.CopyWithoutViewableRows());
+        auto testDataset = trainingDataset;
 
-        const int trainingDatasetSize = dataset.Features.GetNumOfRows() * proportionOfTrainingData;
+        const int trainingDatasetSize = features.GetNumOfRows() * proportionOfTrainingData;
         for (int rowIndex = 0; rowIndex < trainingDatasetSize; ++rowIndex)
-            trainingDataset.PushBackViewableRowIndex(rowIndex);
+            trainingDataset.PushBackViewableRowIndex(features.GetViewableTableRowIndex(rowIndex));
 
-        for (int rowIndex = trainingDatasetSize; rowIndex < dataset.Features.GetNumOfRows(); ++rowIndex)
-            testDataset.PushBackViewableRowIndex(rowIndex);
+        for (int rowIndex = trainingDatasetSize; rowIndex < features.GetNumOfRows(); ++rowIndex)
+            testDataset.PushBackViewableRowIndex(features.GetViewableTableRowIndex(rowIndex));
 
         return {trainingDataset, testDataset};
     }
+
+    template<class StoredType>
+    TrainingAndTestDatasets<StoredType>
+    SplitDatasetIntoTestAndTraining(const Datasets::SupervisedLearningDataset<StoredType>& dataset, double proportionOfTrainingData) {
+        return SplitDatasetIntoTestAndTraining(Datasets::SupervisedLearningDatasetView<StoredType>(dataset), proportionOfTrainingData);
+    }
+
+    template<class StoredType>
+    void SaveDatasetToBinaryFile(
+        const Datasets::SupervisedLearningDataset<StoredType>& dataset,
+        const std::string& fileName,
+        const std::vector<std::string>& featureNames = {},
+        const std::vector<std::string>& observationNames = {})
+    {
+        const std::array tables{&dataset.Features, &dataset.Observations};
+        const std::array columnNames{featureNames, observationNames};
+        DataContainers::BinaryTableUtils::SaveTablesToBinaryFile<StoredType>(fileName, tables, columnNames);
+    }
+
+    /// Features and observations read straight from the mapped file until they are modified
+    template<class StoredType>
+    [[nodiscard]] Datasets::SupervisedLearningDataset<StoredType> LoadDatasetFromBinaryFile(const std::string& fileName) {
+        auto tables = DataContainers::BinaryTableUtils::LoadTablesFromBinaryFile<StoredType>(fileName);
+        if (tables.size() != 2)
+            throw std::invalid_argument("Binary file does not contain a supervised learning dataset");
+
+        return {std::move(tables[0]), std::move(tables[1])};
+    }
 }
 
 #endif
@@ -3,13 +3,15 @@
 #include <RangesUtils/ToVectorRangeAdaptor.h>
 #include <DataContainers/Utils/TableUtils.h>
 #include <iostream>
+#include <exception>
 
 #ifdef PrintTrainingTime
 #include <chrono>
 #endif
 
 namespace MachineLearning::TimeSeriesForecastingUtils {
-    double WalkForwardValidation(MachineLearning::RegressionModel &regressor, const Datasets::SupervisedLearningDataset<double>& dataset, int numOfTests) {
+    double WalkForwardValidation(MachineLearning::RegressionModel &regressor, const Datasets::SupervisedLearningDatasetView<double>& dataset, int numOfTests,
+                                 bool isRefittedIncrementally) {
         if (numOfTests <= 0)
             throw std::invalid_argument("Number of tests is less than or equal to zero");
 
@@ -23,12 +25,18 @@ namespace MachineLearning::TimeSeriesForecastingUtils {
         for (int testNum = 0; testNum < numOfTests; ++testNum) {
         #ifdef PrintTrainingTime
             auto start = std::chrono::high_resolution_clock::now();
-            regressor.Fit(trainingDataset);
+            if (testNum == 0 || !isRefittedIncrementally)
+                regressor.Fit(trainingDataset);
+            else
+                regressor.FitIncrementally(trainingDataset);
             auto stop = std::chrono::high_resolution_clock::now();
             std::chrono::microseconds oneTrainingTime = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
             totalTrainingTime += oneTrainingTime;
         #else
-            regressor.Fit(trainingDataset);
+            if (testNum == 0 || !isRefittedIncrementally)
+                regressor.Fit(trainingDataset);
+            else
+                regressor.FitIncrementally(trainingDataset);
         #endif
             predictions.PushBackRow(regressor.Predict(testDataset.Features.GetRow(testNum) | RangesUtils::to_vector));
             trainingDataset.PushBackViewableRowIndex(testDataset.Features.GetViewableTableRowIndex(testNum));
@@ -48,4 +56,66 @@ namespace MachineLearning::TimeSeriesForecastingUtils {
         return CalculateMRPE(testDataset.Observations, DataContainers::TableView(predictions));
     }
 
+    double WalkForwardValidation(MachineLearning::RegressionModel &regressor, const Datasets::SupervisedLearningDataset<double>& dataset, int numOfTests,
+                                 bool isRefittedIncrementally) {
+        return WalkForwardValidation(regressor, Datasets::SupervisedLearningDatasetView<double>(dataset), numOfTests, isRefittedIncrementally);
+    }
+
+    DataContainers::Table<double> GetWalkForwardPredictions(
+        const RegressionModel& prototype,
+        const Datasets::SupervisedLearningDatasetView<double>& dataset,
+        int numOfTests,
+        int maxNumOfConcurrentSteps)
+    {
+        if (numOfTests <= 0)
+            throw std::invalid_argument("Number of tests is less than or equal to zero");
+
+        if (maxNumOfConcurrentSteps <= 0)
+            throw std::invalid_argument("Number of concurrent steps is less than or equal to zero");
+
+        const auto [trainingDataset, testDataset] = SupervisedLearningUtils::SplitDatasetIntoTestAndTraining(dataset, 1. - (double)numOfTests / (double)dataset.Features.GetNumOfRows());
+        DataContainers::Table<double> predictions(numOfTests, trainingDataset.Observations.GetNumOfColumns());
+        std::exception_ptr stepException;
+
+        // Every step owns its model and training view only while it runs, so memory grows with concurrent steps, not with all of them
+        #pragma omp parallel for num_threads(maxNumOfConcurrentSteps) schedule(dynamic)
+        for (int testNum = 0; testNum < numOfTests; ++testNum) {
+            try {
+                auto stepDataset = trainingDataset;
+                for (int i = 0; i < testNum; ++i)
+                    stepDataset.PushBackViewableRowIndex(testDataset.Features.GetViewableTableRowIndex(i));
+
+                const auto regressor = prototype.CreateUnfittedCopy();
+                regressor->Fit(stepDataset);
+                const auto stepPredictions = regressor->Predict(testDataset.Features.GetRow(testNum) | RangesUtils::to_vector);
+                for (int columnIndex = 0; columnIndex < predictions.GetNumOfColumns(); ++columnIndex)
+                    predictions.AtUnchecked(testNum, columnIndex) = stepPredictions[columnIndex];
+            }
+            catch (...) {
+                #pragma omp critical
+                stepException = std::current_exception();
+            }
+        }
+
+        if (stepException)
+            std::rethrow_exception(stepException);
+
+        return predictions;
+    }
+
+    double ParallelWalkForwardValidation(
+        const RegressionModel& prototype,
+        const Datasets::SupervisedLearningDatasetView<double>& dataset,
+        int numOfTests,
+        int maxNumOfConcurrentSteps)
+    {
+        const auto predictions = GetWalkForwardPredictions(prototype, dataset, numOfTests, maxNumOfConcurrentSteps);
+        const auto [trainingDataset, testDataset] = SupervisedLearningUtils::SplitDatasetIntoTestAndTraining(dataset, 1. - (double)numOfTests / (double)dataset.Features.GetNumOfRows());
+
+        for (int testNum = 0; testNum < numOfTests; ++testNum)
+            std::cout   << ">expected=" << testDataset.Observations.GetRow(testNum)
+                        << " predicted=" << predictions.GetRow(testNum) << '\n';
+
+        return CalculateMRPE(testDataset.Observations, DataContainers::TableView(predictions));
+    }
 }
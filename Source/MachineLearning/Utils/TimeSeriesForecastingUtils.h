@@ -3,7 +3,7 @@
 
 #include <DataContainers/Table.h>
 #include <MachineLearning/RegressionModel.h>
-#include <MachineLearning/Datasets/SupervisedLearningDataset.h>
+#include <MachineLearning/Datasets/SupervisedLearningDatasetView.h>
 #include <numeric>
 
 namespace MachineLearning::TimeSeriesForecastingUtils {
@@ -25,14 +25,41 @@ namespace MachineLearning::TimeSeriesForecastingUtils {
         for (int shift = 0; shift < superviseNumOfRows; ++shift)
             for (int seriesRowIndex = 0, superviseColumnIndex = 0; seriesRowIndex < windowSize; ++seriesRowIndex)
                 for (int seriesColumnIndex = 0; seriesColumnIndex < series.GetNumOfColumns(); ++seriesColumnIndex, ++superviseColumnIndex)
-                    if (superviseColumnIndex < featuresLag)
-                        features.At(shift, superviseColumnIndex) = series.At(seriesRowIndex + shift, seriesColumnIndex);
+                    if (superviseColumnIndex < features.GetNumOfColumns())
+                        features.AtUnchecked(shift, superviseColumnIndex) = series.AtUnchecked(seriesRowIndex + shift, seriesColumnIndex);
                     else
-                        observations.At(shift, superviseColumnIndex - featuresLag) = series.At(seriesRowIndex + shift, seriesColumnIndex);
+                        observations.AtUnchecked(shift, superviseColumnIndex - features.GetNumOfColumns()) = series.AtUnchecked(seriesRowIndex + shift, seriesColumnIndex);
 
         return {features, observations};
     }
 
+    /// Same layout as SeriesToSupervised, but every element is read from the series on the fly:
+    /// features column (lag * seriesColumns + c) is series column c shifted down by lag rows
+    template<class StoredType>
+    [[nodiscard]] Datasets::SupervisedLearningDatasetView<StoredType> SeriesToSupervisedView(const DataContainers::Table<StoredType>& series, int featuresLag, int observationsLag) {
+        if (featuresLag <= 0)
+            throw std::invalid_argument("Features lag is less than or equal to zero");
+
+        if (observationsLag <= 0)
+            throw std::invalid_argument("Observations lag is less than or equal to zero");
+
+        const int windowSize = featuresLag + observationsLag;
+        if (windowSize > series.GetNumOfRows())
+            throw std::invalid_argument("Observations or Features lag is too long");
+
+        Datasets::SupervisedLearningDatasetView<StoredType> dataset(series, series);
+        for (int lag = 0; lag < windowSize; ++lag)
+            for (int seriesColumnIndex = 0; seriesColumnIndex < series.GetNumOfColumns(); ++seriesColumnIndex)
+                (lag < featuresLag ? dataset.Features : dataset.Observations).PushBackViewableColumnIndex(seriesColumnIndex, lag);
+
+        // Features alone could be read at more rows than observations, so both views list the rows explicitly
+        const int superviseNumOfRows = series.GetNumOfRows() - windowSize + 1;
+        for (int rowIndex = 0; rowIndex < superviseNumOfRows; ++rowIndex)
+            dataset.PushBackViewableRowIndex(rowIndex);
+
+        return dataset;
+    }
+
     template<class StoredType, class FuncType>
     [[nodiscard]] double CalculateMeanError(
         const DataContainers::TableView<StoredType>& observations,
@@ -47,14 +74,9 @@ namespace MachineLearning::TimeSeriesForecastingUtils {
 
         double meanError = 0.0;
         const auto n = static_cast<double>(observations.GetNumOfRows() * observations.GetNumOfColumns());
-        for (int rowIndex = 0; rowIndex < observations.GetNumOfRows(); ++rowIndex) {
-            auto observationRow = observations.GetRow(rowIndex);
-            auto predictionRow = predictions.GetRow(rowIndex);
-
-            meanError += std::transform_reduce(observationRow.begin(), observationRow.end(), predictionRow.begin(), 0.0,
-                                         std::plus(),
-                                         [n, &calculateElementError](double observation, double prediction){ return calculateElementError(observation, prediction) / n; });
-        }
+        for (int rowIndex = 0; rowIndex < observations.GetNumOfRows(); ++rowIndex)
+            for (int columnIndex = 0; columnIndex < observations.GetNumOfColumns(); ++columnIndex)
+                meanError += calculateElementError(observations.AtUnchecked(rowIndex, columnIndex), predictions.AtUnchecked(rowIndex, columnIndex)) / n;
 
         return meanError;
     }
@@ -71,7 +93,26 @@ namespace MachineLearning::TimeSeriesForecastingUtils {
             [](double observation, double prediction){ return std::abs(observation - prediction) / observation; }) * 100;
     }
 
-    [[nodiscard]] double WalkForwardValidation(RegressionModel& regressor, const Datasets::SupervisedLearningDataset<double>& dataset, int numOfTests);
+    /// Every step refits the regressor from scratch. Incremental refits reuse the previous step's fit instead and are faster,
+    /// but ensembles then refit only some of their trees, so the error may differ from the one of full refits
+    [[nodiscard]] double WalkForwardValidation(RegressionModel& regressor, const Datasets::SupervisedLearningDatasetView<double>& dataset, int numOfTests,
+                                               bool isRefittedIncrementally = false);
+    [[nodiscard]] double WalkForwardValidation(RegressionModel& regressor, const Datasets::SupervisedLearningDataset<double>& dataset, int numOfTests,
+                                               bool isRefittedIncrementally = false);
+
+    /// Steps of the walk-forward validation run independently on unfitted copies of the prototype, at most maxNumOfConcurrentSteps at a time.
+    /// Step i is fitted on the training rows followed by the first i test rows and predicts the test row i, predictions are in step order
+    [[nodiscard]] DataContainers::Table<double> GetWalkForwardPredictions(
+        const RegressionModel& prototype,
+        const Datasets::SupervisedLearningDatasetView<double>& dataset,
+        int numOfTests,
+        int maxNumOfConcurrentSteps);
+
+    [[nodiscard]] double ParallelWalkForwardValidation(
+        const RegressionModel& prototype,
+        const Datasets::SupervisedLearningDatasetView<double>& dataset,
+        int numOfTests,
+        int maxNumOfConcurrentSteps);
 }
 
 #endif
@@ -0,0 +1,41 @@
+#include "AliasTable.h"
+#include <numeric>
+#include <stdexcept>
+
+namespace RandomGenerators {
+    AliasTable::AliasTable(std::span<const double> weights)
+        : m_probabilities(weights.size(), 1.0)
+        , m_aliases(weights.size())
+    {
+        const double sumOfWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+        if (weights.empty() || !(sumOfWeights > 0.0))
+            throw std::invalid_argument("Weights of the alias table have no positive sum");
+
+        std::iota(m_aliases.begin(), m_aliases.end(), 0);
+
+        // Vose's method: every underfull column is topped up by one overfull index, which is then underfull or overfull itself
+        std::vector<int> underfullIndexes;
+        std::vector<int> overfullIndexes;
+        std::vector<double> scaledWeights(weights.size());
+        for (int i = 0; i < std::ssize(weights); ++i) {
+            scaledWeights[i] = weights[i] * std::ssize(weights) / sumOfWeights;
+            (scaledWeights[i] < 1.0 ? underfullIndexes : overfullIndexes).push_back(i);
+        }
+
+        while (!underfullIndexes.empty() && !overfullIndexes.empty()) {
+            const int underfullIndex = underfullIndexes.back();
+            const int overfullIndex = overfullIndexes.back();
+            underfullIndexes.pop_back();
+
+            m_probabilities[underfullIndex] = scaledWeights[underfullIndex];
+            m_aliases[underfullIndex] = overfullIndex;
+
+            scaledWeights[overfullIndex] -= 1.0 - scaledWeights[underfullIndex];
+            if (scaledWeights[overfullIndex] < 1.0) {
+                overfullIndexes.pop_back();
+                underfullIndexes.push_back(overfullIndex);
+            }
+        }
+        // Columns left in either list are full up to rounding errors and keep their own index
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef DECISION_TREE_2_ALIASTABLE_H
+#define DECISION_TREE_2_ALIASTABLE_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <RandomGenerators/PhiloxRandom.h>
+
+namespace RandomGenerators {
+    /// Walker's alias table, draws indexes in proportion to their weights with two random numbers per draw
+    class AliasTable {
+    public:
+        /// Weights don't have to be normalized, but have to be non-negative with a positive sum
+        explicit AliasTable(std::span<const double> weights);
+
+        [[nodiscard]] int operator()(PhiloxRandom& generator) const {
+            const auto index = static_cast<int>(static_cast<std::uint64_t>(generator()) * m_probabilities.size() >> 32);
+            const double uniform = generator() * 0x1p-32;
+            return uniform < m_probabilities[index] ? index : m_aliases[index];
+        }
+
+        [[nodiscard]] int GetSize() const { return static_cast<int>(m_probabilities.size()); }
+
+    private:
+        std::vector<double> m_probabilities;    ///< Probability to keep the drawn index instead of taking its alias
+        std::vector<int> m_aliases;
+    };
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "PhiloxRandom.h"
+#include <random>
+
+namespace {
+    constexpr std::uint32_t PhiloxMultiplier0 = 0xD2511F53;
+    constexpr std::uint32_t PhiloxMultiplier1 = 0xCD9E8D57;
+    constexpr std::uint32_t PhiloxKeyIncrement0 = 0x9E3779B9;
+    constexpr std::uint32_t PhiloxKeyIncrement1 = 0xBB67AE85;
+    constexpr int NumOfPhiloxRounds = 10;
+
+    /// SplitMix64 finalizer
+    std::uint64_t MixBits(std::uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        return value ^ (value >> 31);
+    }
+}
+
+namespace RandomGenerators {
+    PhiloxRandom::PhiloxRandom(std::uint64_t seed, std::uint64_t stream)
+        : m_key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}
+        , m_counter{0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32)}
+        , m_outputIndex(std::ssize(m_output))
+    {}
+
+    std::uint64_t PhiloxRandom::GetChildStream(std::uint64_t stream, std::uint64_t childIndex) {
+        return MixBits(MixBits(stream) + childIndex + 1);
+    }
+
+    std::uint64_t PhiloxRandom::GetNondeterministicSeed() {
+        std::random_device randomDevice;
+        return static_cast<std::uint64_t>(randomDevice()) << 32 | randomDevice();
+    }
+
+    void PhiloxRandom::GenerateBlock() {
+        auto counter = m_counter;
+        auto key = m_key;
+        for (int round = 0; round < NumOfPhiloxRounds; ++round) {
+            const std::uint64_t product0 = static_cast<std::uint64_t>(PhiloxMultiplier0) * counter[0];
+            const std::uint64_t product1 = static_cast<std::uint64_t>(PhiloxMultiplier1) * counter[2];
+            counter = {
+                static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<std::uint32_t>(product1),
+                static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<std::uint32_t>(product0)
+            };
+            key[0] += PhiloxKeyIncrement0;
+            key[1] += PhiloxKeyIncrement1;
+        }
+
+        m_output = counter;
+        m_outputIndex = 0;
+        if (++m_counter[0] == 0)
+            ++m_counter[1];
+    }
+}
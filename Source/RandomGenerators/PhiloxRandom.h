@@ -0,0 +1,43 @@
+#ifndef DECISION_TREE_2_PHILOXRANDOM_H
+#define DECISION_TREE_2_PHILOXRANDOM_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace RandomGenerators {
+    /// Philox4x32-10 counter-based generator. Numbers depend only on the seed, the stream and their position in it,
+    /// so every tree, node or bootstrap draws from its own stream whatever thread it runs on
+    class PhiloxRandom {
+    public:
+        using result_type = std::uint32_t;
+
+        PhiloxRandom(std::uint64_t seed, std::uint64_t stream);
+
+        result_type operator()() {
+            if (m_outputIndex == std::ssize(m_output))
+                GenerateBlock();
+
+            return m_output[m_outputIndex++];
+        }
+
+        static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /// Stream of the child with the given index, the same on every run
+        [[nodiscard]] static std::uint64_t GetChildStream(std::uint64_t stream, std::uint64_t childIndex);
+        /// Seed of models that weren't given one
+        [[nodiscard]] static std::uint64_t GetNondeterministicSeed();
+
+    private:
+        void GenerateBlock();
+
+    private:
+        std::array<std::uint32_t, 2> m_key;
+        std::array<std::uint32_t, 4> m_counter;     ///< Block index in the first two words, stream in the last two
+        std::array<result_type, 4> m_output{};
+        int m_outputIndex;
+    };
+}
+
+#endif
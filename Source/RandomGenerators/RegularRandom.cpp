@@ -1,6 +0,0 @@
-#include "RegularRandom.h"
-
-namespace RandomGenerators {
-    std::mt19937 RegularRandom::s_randomGenerator(std::random_device{}());
-    RegularRandom RegularRandom::Generator{};
-}
\ No newline at end of file
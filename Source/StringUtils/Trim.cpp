@@ -33,4 +33,12 @@ namespace StringUtils {
         TrimRight(str);
         return str;
     }
+
+    std::string_view TrimView(std::string_view str) {
+        const auto firstChar = std::find_if(str.begin(), str.end(),
+                                            [](unsigned char c) { return !std::isspace(c); });
+        const auto lastChar = std::find_if(str.rbegin(), std::make_reverse_iterator(firstChar),
+                                           [](unsigned char c) { return !std::isspace(c); });
+        return {firstChar, lastChar.base()};
+    }
 }
@@ -2,6 +2,7 @@
 #define DECISION_TREE_2_TRIM_H
 
 #include <string>
+#include <string_view>
 
 namespace StringUtils {
     void Trim(std::string& str);
@@ -12,6 +13,8 @@ namespace StringUtils {
 
     void TrimRight(std::string& str);
     std::string TrimRightCopy(std::string str);
+
+    [[nodiscard]] std::string_view TrimView(std::string_view str);
 }
 
 #endif
@@ -0,0 +1,12 @@
+# add_compiled_regression_model(<target> <generated source>)
+#
+# Builds a source file produced by MachineLearning::CodeGenerationUtils into a shared library
+# that MachineLearning::CompiledModels::CompiledRegressionModel can load at runtime.
+function(add_compiled_regression_model TARGET_NAME GENERATED_SOURCE)
+    add_library(${TARGET_NAME} SHARED ${GENERATED_SOURCE})
+    set_target_properties(${TARGET_NAME} PROPERTIES
+        CXX_STANDARD 23
+        CXX_STANDARD_REQUIRED ON
+        UNITY_BUILD OFF
+        PREFIX "")
+endfunction()
@@ -6,6 +6,7 @@
 #include <MachineLearning/DecisionTrees/DecisionTreeRegressor.h>
 #include <MachineLearning/Ensembles/RandomForestRegressor.h>
 #include <MachineLearning/Ensembles/AdaBoostRegressor.h>
+#include <MachineLearning/Ensembles/GradientBoostingRegressor.h>
 
 int main() {
     const auto trainingDataset = []{
@@ -25,6 +26,7 @@ int main() {
 
     // auto regressor = MachineLearning::Ensembles::RandomForestRegressor(1000, 0.75, 5, 3, 0.75);
     auto regressor = MachineLearning::Ensembles::AdaBoostRegressor(1000, 6);
+    // auto regressor = MachineLearning::Ensembles::GradientBoostingRegressor(100, 0.1, 0.8, 3, 3);
 
     const auto mrpe = MachineLearning::TimeSeriesForecastingUtils::WalkForwardValidation(regressor, trainingDataset, 10);
     std::cout << "Evaluation: " << std::setprecision(2) << std::fixed << 100 - mrpe << "%\n";